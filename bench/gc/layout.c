@@ -0,0 +1,139 @@
+// Mixed-struct heap, allocated the way V-generated code does (GC_MALLOC
+// for everything), with GC_MALLOC_ATOMIC for byte buffers only, or with
+// precise layouts from gc_layout.h as well, as LAYOUT in the environment
+// says (conservative, atomic or typed). Records hold a few
+// pointers among many numbers, and some of those numbers are addresses
+// of temporaries the program has dropped, as hash keys derived from
+// pointers are. Prints the heap size and the live bytes after a full
+// collection, and the median mark time (from libgc-telemetry).
+//   layout [records in thousands] [collections]
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <gc/gc.h>
+#include <gc/gc_layout.h>
+#include <gc/gc_telemetry.h>
+
+typedef struct {
+	unsigned char *str;
+	int len;
+	int is_lit;
+} string;
+
+typedef struct {
+	void *data;
+	int offset, len, cap, flags;
+	int element_size;
+} array;
+
+typedef struct {
+	double x, y, z;
+	long weight;
+	void *next;
+} Point;
+
+typedef struct User {
+	string name;
+	uint64_t id;
+	double scores[8];
+	struct User *friend;
+	array points;
+	uint64_t keys[4];
+	uint64_t created, updated;
+} User;
+
+GC_LAYOUT(Point, GC_LAYOUT_PTR(Point, next))
+GC_LAYOUT(User, GC_LAYOUT_PTR(User, name.str), GC_LAYOUT_PTR(User, friend),
+	GC_LAYOUT_PTR(User, points.data))
+
+static int typed, atomic;
+
+static void *alloc_point(void) {
+	return typed ? GC_LAYOUT_NEW(Point) : GC_MALLOC(sizeof(Point));
+}
+
+static User *alloc_user(void) {
+	return typed ? GC_LAYOUT_NEW(User) : GC_MALLOC(sizeof(User));
+}
+
+static void *alloc_bytes(size_t n) {
+	return atomic ? GC_MALLOC_ATOMIC(n) : GC_MALLOC(n);
+}
+
+static int cmp(const void *a, const void *b) {
+	unsigned long x = *(const unsigned long *)a, y = *(const unsigned long *)b;
+	return x < y ? -1 : x > y;
+}
+
+int main(int argc, char **argv) {
+	long n = (argc > 1 ? atol(argv[1]) : 200) * 1000;
+	int runs = argc > 2 ? atoi(argv[2]) : 5;
+	const char *env = getenv("LAYOUT");
+	unsigned long seed = 88172645463325252UL;
+	const struct GC_telemetry_ring *ring;
+	struct GC_telemetry_record rec;
+	unsigned long *marks;
+	User **users;
+	char path[64];
+
+	typed = env != NULL && strcmp(env, "typed") == 0;
+	atomic = typed || (env != NULL && strcmp(env, "atomic") == 0);
+	GC_INIT();
+	snprintf(path, sizeof(path), "/tmp/layout.%d.gc", (int)getpid());
+	if (GC_telemetry_start(path, 64) != 0) {
+		perror(path);
+		return 1;
+	}
+	ring = GC_telemetry_get_ring();
+
+	users = GC_MALLOC(n * sizeof(*users));
+	for (long i = 0; i < n; i++) {
+		User *u = alloc_user();
+		Point **points;
+
+		u->name.len = 24;
+		u->name.str = alloc_bytes(u->name.len + 1);
+		snprintf((char *)u->name.str, u->name.len + 1, "user-%ld", i);
+		u->id = i;
+		for (int k = 0; k < 8; k++) {
+			seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+			u->scores[k] = (double)(seed >> 11) / (1UL << 53);
+		}
+		u->points.len = u->points.cap = 4;
+		u->points.element_size = sizeof(void *);
+		u->points.data = points = GC_MALLOC(4 * sizeof(*points));
+		for (int k = 0; k < 4; k++) {
+			points[k] = alloc_point();
+			points[k]->x = k, points[k]->weight = i;
+		}
+		// One key is made from the address of a scratch buffer that is
+		// dropped straight away, the others are hashes.
+		u->keys[0] = (uintptr_t)alloc_bytes(256);
+		for (int k = 1; k < 4; k++) {
+			seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+			u->keys[k] = seed;
+		}
+		u->created = u->updated = i * 1000003;
+		users[i] = u;
+	}
+	for (long i = 0; i < n; i++) {
+		seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+		users[i]->friend = users[seed % n];
+	}
+
+	marks = calloc(runs, sizeof(*marks));
+	for (int r = 0; r < runs; r++) {
+		GC_gcollect();
+		if (!GC_telemetry_read(ring, ring->head - 1, &rec))
+			return 1;
+		marks[r] = rec.mark_ns;
+	}
+	qsort(marks, runs, sizeof(*marks), cmp);
+	printf("heap_mib %.1f live_mib %.1f mark_ms %.1f\n", GC_get_heap_size() / 1048576.0,
+		(GC_get_heap_size() - GC_get_free_bytes()) / 1048576.0, marks[runs / 2] / 1e6);
+	GC_telemetry_stop();
+	remove(path);
+	return users[0]->friend == NULL;
+}
@@ -0,0 +1,89 @@
+// GCBench-style mark benchmark: a large live heap of small nodes linked in
+// random order, so marking touches pages all over the heap, then a number
+// of full collections. Prints the median mark time (from libgc-telemetry)
+// and how much of the heap the kernel backed with huge pages.
+//   marktree [heap MiB] [collections]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <gc/gc.h>
+#include <gc/gc_telemetry.h>
+
+struct node {
+	struct node *next, *other;
+	long payload[2];
+};
+
+static int cmp(const void *a, const void *b) {
+	unsigned long x = *(const unsigned long *)a, y = *(const unsigned long *)b;
+	return x < y ? -1 : x > y;
+}
+
+static long anon_huge_kib(void) {
+	char line[256];
+	long kib = -1;
+	FILE *f = fopen("/proc/self/smaps_rollup", "r");
+	if (f == NULL)
+		return -1;
+	while (fgets(line, sizeof(line), f))
+		if (sscanf(line, "AnonHugePages: %ld kB", &kib) == 1)
+			break;
+	fclose(f);
+	return kib;
+}
+
+int main(int argc, char **argv) {
+	long mib = argc > 1 ? atol(argv[1]) : 512;
+	int runs = argc > 2 ? atoi(argv[2]) : 5;
+	size_t n = (size_t)mib << 20 >> 5;
+	struct node **nodes;
+	unsigned long *marks;
+	unsigned long seed = 88172645463325252UL;
+	const struct GC_telemetry_ring *ring;
+	struct GC_telemetry_record rec;
+	char path[64];
+
+	GC_INIT();
+	snprintf(path, sizeof(path), "/tmp/marktree.%d.gc", (int)getpid());
+	if (GC_telemetry_start(path, 64) != 0) {
+		perror(path);
+		return 1;
+	}
+	ring = GC_telemetry_get_ring();
+
+	// The index keeps the nodes alive until they are chained; it is
+	// cleared before the timed collections, so they mark the nodes alone.
+	nodes = GC_MALLOC(n * sizeof(*nodes));
+	for (size_t i = 0; i < n; i++)
+		nodes[i] = GC_MALLOC(sizeof(struct node));
+	for (size_t i = n - 1; i > 0; i--) {
+		size_t j;
+		struct node *t;
+		seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+		j = seed % (i + 1);
+		t = nodes[i], nodes[i] = nodes[j], nodes[j] = t;
+	}
+	for (size_t i = 0; i + 1 < n; i++) {
+		nodes[i]->next = nodes[i + 1];
+		nodes[i]->other = nodes[(i * 7919) % n];
+	}
+	// Keep the chain alive through its head only.
+	struct node *volatile head = nodes[0];
+	memset(nodes, 0, n * sizeof(*nodes));
+
+	marks = calloc(runs, sizeof(*marks));
+	for (int r = 0; r < runs; r++) {
+		GC_gcollect();
+		if (!GC_telemetry_read(ring, ring->head - 1, &rec))
+			return 1;
+		marks[r] = rec.mark_ns;
+	}
+	qsort(marks, runs, sizeof(*marks), cmp);
+	printf("heap_mib %lu mark_ms %.1f anon_huge_mib %ld\n",
+		(unsigned long)(GC_get_heap_size() >> 20), marks[runs / 2] / 1e6,
+		anon_huge_kib() / 1024);
+	GC_telemetry_stop();
+	remove(path);
+	return head == NULL;
+}
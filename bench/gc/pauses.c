@@ -0,0 +1,114 @@
+// Pause benchmark for incremental collection: a live heap of small nodes
+// in random order, which the program keeps rewiring and replacing. Every
+// allocation is timed, collection work included, and the longest and the
+// 99.9th percentile are printed with the total run time. Afterwards every
+// node still reachable is checked, and the run fails if the collector
+// freed one that the program could only reach through pointers it wrote
+// while a collection was under way.
+//   pauses [heap MiB] [million replacements]
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <gc/gc.h>
+
+// serial is unique to each node (32 bits are plenty), links holds the
+// serials of next (low half) and other (high half) as the program set
+// them. A node the collector wrongly freed is overwritten by the free
+// list or by a later allocation, so the serials no longer match.
+struct node {
+	struct node *next, *other;
+	unsigned long serial, links;
+};
+
+static void set_next(struct node *x, struct node *next) {
+	x->next = next;
+	x->links = (x->links & ~0xffffffffUL) | (next ? next->serial : 0);
+}
+
+static void set_other(struct node *x, struct node *other) {
+	x->other = other;
+	x->links = (x->links & 0xffffffffUL) | (other ? other->serial : 0) << 32;
+}
+
+static int linked(const struct node *y, unsigned long serial) {
+	return y == NULL ? serial == 0 : y->serial == serial;
+}
+
+static unsigned long now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+	long mib = argc > 1 ? atol(argv[1]) : 192;
+	long iters = (argc > 2 ? atol(argv[2]) : 10) * 1000000;
+	size_t n = (size_t)mib << 20 >> 5;
+	// Allocation latencies in microseconds, the last bucket catching
+	// everything from 100 ms up.
+	static unsigned long hist[100001];
+	unsigned long seed = 88172645463325252UL, start, t, max = 0, seen = 0;
+	unsigned long serial = 0, lost = 0;
+	// The serial of the node in each slot, outside the collected heap.
+	uint32_t *serials = malloc(n * sizeof(*serials));
+	struct node **nodes;
+	long p999 = 0;
+
+	GC_INIT();
+	nodes = GC_MALLOC(n * sizeof(*nodes));
+	for (size_t i = 0; i < n; i++) {
+		nodes[i] = GC_MALLOC(sizeof(struct node));
+		nodes[i]->serial = serials[i] = ++serial;
+	}
+	for (size_t i = 0; i < n; i++) {
+		seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+		set_next(nodes[i], nodes[seed % n]);
+	}
+
+	start = now_ns();
+	for (long r = 0; r < iters; r++) {
+		struct node *x;
+		size_t i, j;
+
+		seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+		i = seed % n;
+		j = (seed >> 32) % n;
+		t = now_ns();
+		x = GC_MALLOC(sizeof(struct node));
+		t = now_ns() - t;
+		hist[t / 1000 < 100000 ? t / 1000 : 100000]++;
+		if (t > max)
+			max = t;
+		// Replace a node, which becomes garbage unless another one
+		// still points to it, and point an old node at the new one,
+		// so pages the collector has already marked get written.
+		x->serial = serials[i] = ++serial;
+		set_next(x, nodes[i]->next);
+		set_other(x, nodes[i]->other);
+		nodes[i] = x;
+		set_other(nodes[j], x);
+	}
+	t = now_ns() - start;
+	for (size_t i = 0; i < n; i++) {
+		struct node *x = nodes[i];
+
+		if (x->serial != serials[i] || !linked(x->next, x->links & 0xffffffffUL)
+		    || !linked(x->other, x->links >> 32))
+			lost++;
+	}
+	if (lost != 0) {
+		fprintf(stderr, "pauses: %lu of %zu slots reach a node the collector freed\n", lost, n);
+		return 1;
+	}
+	for (long us = 100000; us >= 0; us--) {
+		seen += hist[us];
+		if (seen * 1000 > (unsigned long)iters) {
+			p999 = us;
+			break;
+		}
+	}
+	printf("max_pause_ms %.1f p999_us %ld total_s %.2f gcs %lu\n", max / 1e6, p999, t / 1e9,
+		(unsigned long)GC_get_gc_no());
+	return 0;
+}
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Collector benchmarks for the root's libgc.
+
+Links each program in this directory statically against the root, runs
+every variant of it --runs times and prints the median of each number
+the program reports:
+
+    bench/gc/run.py
+    bench/gc/run.py marktree --args 1024 5
+
+A variant is the same binary run with a different environment, such as
+GC_HUGEPAGES=off and GC_HUGEPAGES=thp for libgc-hugepage, or incremental
+collection on the mprotect and the userfaultfd dirty bits of libgc-uffd,
+or LAYOUT=conservative, atomic and typed for gc_layout.h.
+"""
+
+import argparse
+import collections
+import os
+import shlex
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(os.path.dirname(HERE))
+sys.path.insert(0, os.path.join(os.path.dirname(HERE), 'link'))
+from run import GCCDIR, LIBDIR, RUNTIME_LIBDIR, default_cc  # noqa: E402
+
+# name: (libraries, default arguments, {variant: environment})
+PROGRAMS = {
+	'marktree': (['-lgc-telemetry', '-lgc-hugepage', '-lpthread'], ['512', '5'], {
+		'4k': {'GC_HUGEPAGES': 'off'},
+		'thp': {'GC_HUGEPAGES': 'thp'},
+	}),
+	'pauses': (['-lgc-uffd', '-lpthread'], ['192', '5'], {
+		'full': {},
+		'mprotect': {'GC_ENABLE_INCREMENTAL': '1', 'GC_VDB': 'mprotect'},
+		'uffd': {'GC_ENABLE_INCREMENTAL': '1'},
+	}),
+	'layout': (['-lgc-telemetry', '-lgc', '-lpthread'], ['200', '5'], {
+		'conservative': {'LAYOUT': 'conservative'},
+		'atomic': {'LAYOUT': 'atomic'},
+		'typed': {'LAYOUT': 'typed'},
+	}),
+}
+
+
+def link(cc, name, obj, out):
+	libs, _, _ = PROGRAMS[name]
+	crt = lambda f: os.path.join(LIBDIR, f)
+	cmd = cc + ['-nostdlib', '-static', '--sysroot=' + ROOT, '-L' + LIBDIR, '-L' + RUNTIME_LIBDIR,
+		crt('crt1.o'), crt('crti.o'), os.path.join(GCCDIR, 'crtbeginT.o'), obj] + libs
+	cmd += ['-Wl,--start-group', '-lc', os.path.join(GCCDIR, 'libgcc.a'),
+		os.path.join(GCCDIR, 'libgcc_eh.a'), '-Wl,--end-group']
+	cmd += [os.path.join(GCCDIR, 'crtend.o'), crt('crtn.o'), '-o', out]
+	subprocess.run(cmd, check=True, stderr=subprocess.DEVNULL)
+
+
+def run(binary, args, env):
+	"""Runs binary and returns the 'key value' pairs it prints as floats."""
+	out = subprocess.run([binary] + args, env=dict(os.environ, **env), check=True,
+		stdout=subprocess.PIPE, universal_newlines=True).stdout.split()
+	return collections.OrderedDict((k, float(v)) for k, v in zip(out[::2], out[1::2]))
+
+
+def main():
+	parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+	parser.add_argument('--runs', type=int, default=3, help='runs per variant (default 3)')
+	parser.add_argument('--cc', default=os.environ.get('CC') or default_cc(),
+		help='compiler targeting x86_64 Linux (default: $CC, cc on x86_64 Linux, else clang)')
+	parser.add_argument('--args', nargs='*', help="arguments for the programs (default: each program's own)")
+	parser.add_argument('programs', nargs='*', default=list(PROGRAMS), help='subset to run')
+	args = parser.parse_args()
+
+	cc = shlex.split(args.cc)
+	work = tempfile.mkdtemp(prefix='vlinuxroot-gcbench-')
+	try:
+		for name in args.programs:
+			_, default_args, variants = PROGRAMS[name]
+			obj = os.path.join(work, name + '.o')
+			binary = os.path.join(work, name)
+			subprocess.run(cc + ['-O2', '-fno-pie', '-isystem', os.path.join(ROOT, 'include'),
+				'-c', os.path.join(HERE, name + '.c'), '-o', obj], check=True)
+			link(cc, name, obj, binary)
+			results = collections.OrderedDict()
+			# Interleave the variants so drift affects them alike.
+			for _ in range(args.runs):
+				for variant, env in variants.items():
+					for k, v in run(binary, args.args or default_args, env).items():
+						results.setdefault(variant, collections.OrderedDict()).setdefault(k, []).append(v)
+			keys = list(next(iter(results.values())))
+			print('%-10s %-12s' % (name, 'variant') + ''.join('%16s' % k for k in keys))
+			for variant, values in results.items():
+				print('%-10s %-12s' % ('', variant) + ''.join('%16.1f' % statistics.median(values[k]) for k in keys))
+	finally:
+		shutil.rmtree(work)
+
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,27 @@
+// Linked with -static: the archives a self-contained V service pulls in,
+// libgc, OpenSSL and zlib. The reference program for sizes.py.
+#include <stdio.h>
+#include <string.h>
+#include <gc/gc.h>
+#include <openssl/sha.h>
+#include <openssl/ssl.h>
+#include <zlib.h>
+
+int main(void) {
+	unsigned char digest[SHA256_DIGEST_LENGTH];
+	unsigned char packed[256];
+	uLongf packed_len = sizeof(packed);
+	SSL_CTX *ctx;
+	char *buf;
+
+	GC_INIT();
+	buf = GC_MALLOC_ATOMIC(64);
+	strcpy(buf, "hello from a static V service");
+	SHA256((unsigned char *)buf, strlen(buf), digest);
+	compress(packed, &packed_len, (unsigned char *)buf, strlen(buf));
+	ctx = SSL_CTX_new(TLS_server_method());
+	printf("%02x%02x %lu %s\n", digest[0], digest[1], (unsigned long)packed_len,
+		ctx ? "tls" : "no tls");
+	SSL_CTX_free(ctx);
+	return 0;
+}
@@ -0,0 +1,34 @@
+// Opens a double buffered GLX window and clears it, like a minimal gg app.
+#include <X11/Xlib.h>
+#include <GL/gl.h>
+#include <GL/glx.h>
+
+int main(void) {
+	int attrs[] = { GLX_RGBA, GLX_DEPTH_SIZE, 24, GLX_DOUBLEBUFFER, None };
+	Display *dpy = XOpenDisplay(NULL);
+	XVisualInfo *vi;
+	XSetWindowAttributes swa;
+	Window root, win;
+	GLXContext glc;
+	if (dpy == NULL)
+		return 1;
+	root = DefaultRootWindow(dpy);
+	vi = glXChooseVisual(dpy, DefaultScreen(dpy), attrs);
+	if (vi == NULL)
+		return 1;
+	swa.colormap = XCreateColormap(dpy, root, vi->visual, AllocNone);
+	swa.event_mask = ExposureMask | KeyPressMask;
+	win = XCreateWindow(dpy, root, 0, 0, 640, 480, 0, vi->depth, InputOutput,
+		vi->visual, CWColormap | CWEventMask, &swa);
+	XMapWindow(dpy, win);
+	glc = glXCreateContext(dpy, vi, NULL, GL_TRUE);
+	glXMakeCurrent(dpy, win, glc);
+	glClearColor(0.2f, 0.3f, 0.4f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glXSwapBuffers(dpy, win);
+	glXMakeCurrent(dpy, None, NULL);
+	glXDestroyContext(dpy, glc);
+	XDestroyWindow(dpy, win);
+	XCloseDisplay(dpy);
+	return 0;
+}
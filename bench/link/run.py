@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Link-time benchmark for the root.
+
+Compiles the programs in this directory once, then links each of them
+--runs times with the given linker against the root, and prints the median
+wall time, the peak RSS of the linker and the size of the output:
+
+    bench/link/run.py
+    bench/link/run.py --runs 10 --ld ~/lld-new/ld.lld
+    CC='clang --target=x86_64-linux-gnu' LD=ld.lld bench/link/run.py
+
+Run it before and after changing an archive or the linker and compare.
+Only the link is timed; compilation happens up front.
+"""
+
+import argparse
+import os
+import platform
+import shlex
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(os.path.dirname(HERE))
+LIBDIR = os.path.join(ROOT, 'usr', 'lib', 'x86_64-linux-gnu')
+RUNTIME_LIBDIR = os.path.join(ROOT, 'lib', 'x86_64-linux-gnu')
+GCCDIR = os.path.join(ROOT, 'usr', 'lib', 'gcc', 'x86_64-linux-gnu', '12')
+
+# name: (static, libraries)
+PROGRAMS = {
+	'hello': (False, ['-lc']),
+	'server': (False, ['-luv', '-lssl', '-lcrypto', '-lpthread', '-ldl', '-lc']),
+	'glx': (False, ['-lGL', '-lX11', '-lc']),
+	'static': (True, ['-lm', '-lpthread']),
+	'gcstatic': (True, ['-lgc', '-lssl', '-lcrypto', '-lz', '-lpthread', '-ldl']),
+}
+
+
+def default_cc():
+	if platform.system() == 'Linux' and platform.machine() == 'x86_64':
+		return 'cc'
+	return 'clang --target=x86_64-linux-gnu'
+
+
+def default_ld():
+	bundled = os.path.join(ROOT, 'ld.lld')
+	if platform.system() == 'Darwin':
+		return bundled
+	return shutil.which('ld.lld') or 'ld.lld'
+
+
+def link_command(ld, name, obj, out, gccdir):
+	static, libs = PROGRAMS[name]
+	crt = lambda f: os.path.join(LIBDIR, f)
+	cmd = ld + ['--sysroot=' + ROOT, '-m', 'elf_x86_64', '-L' + LIBDIR, '-L' + RUNTIME_LIBDIR]
+	if static:
+		cmd += ['-static', crt('crt1.o'), crt('crti.o'), os.path.join(gccdir, 'crtbeginT.o'), obj]
+		cmd += libs + ['--start-group', '-lc', os.path.join(gccdir, 'libgcc.a'),
+			os.path.join(gccdir, 'libgcc_eh.a'), '--end-group']
+		cmd += [os.path.join(gccdir, 'crtend.o'), crt('crtn.o')]
+	else:
+		cmd += ['-dynamic-linker', '/lib64/ld-linux-x86-64.so.2']
+		cmd += [crt('crt1.o'), crt('crti.o'), obj] + libs + [crt('crtn.o')]
+	return cmd + ['-o', out]
+
+
+def measure(cmd):
+	"""Runs cmd and returns (wall seconds, peak RSS in KiB)."""
+	# stderr goes to a file, not a pipe: nothing reads a pipe before
+	# wait4, and a linker writing more than the pipe holds would block.
+	with tempfile.TemporaryFile() as errfile:
+		start = time.perf_counter()
+		proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=errfile)
+		_, status, usage = os.wait4(proc.pid, 0)
+		wall = time.perf_counter() - start
+		proc.returncode = os.waitstatus_to_exitcode(status)
+		errfile.seek(0)
+		err = errfile.read().decode(errors='replace')
+	if proc.returncode != 0:
+		raise RuntimeError('link failed: %s\n%s' % (' '.join(cmd), err))
+	# ru_maxrss is in bytes on macOS and in KiB elsewhere.
+	rss = usage.ru_maxrss // 1024 if sys.platform == 'darwin' else usage.ru_maxrss
+	return wall, rss
+
+
+def rss_floor():
+	"""Peak RSS reported for a trivial child.
+
+	On Linux a child's ru_maxrss includes the RSS it had before exec, i.e.
+	this interpreter's, so a linker that stays below that cannot be told
+	apart from it.
+	"""
+	return measure(['true'])[1]
+
+
+def main():
+	parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+	parser.add_argument('--runs', type=int, default=5, help='links per program (default 5)')
+	parser.add_argument('--cc', default=os.environ.get('CC') or default_cc(),
+		help='compiler targeting x86_64 Linux (default: $CC, cc on x86_64 Linux, else clang)')
+	parser.add_argument('--ld', default=os.environ.get('LD') or default_ld(),
+		help='linker to measure (default: $LD, the bundled ld.lld on macOS, else ld.lld)')
+	parser.add_argument('--gccdir', default=GCCDIR,
+		help='directory with crtbeginT.o, libgcc.a and libgcc_eh.a for the static link')
+	parser.add_argument('programs', nargs='*', default=list(PROGRAMS), help='subset to run')
+	args = parser.parse_args()
+
+	cc = shlex.split(args.cc)
+	ld = shlex.split(args.ld)
+	work = tempfile.mkdtemp(prefix='vlinuxroot-bench-')
+	try:
+		floor = rss_floor()
+		print('%-8s %10s %10s %12s' % ('program', 'wall_ms', 'rss_kib', 'size_bytes'))
+		for name in args.programs:
+			static, _ = PROGRAMS[name]
+			if static and not os.path.exists(os.path.join(args.gccdir, 'libgcc_eh.a')):
+				print('%-8s skipped: no libgcc_eh.a in %s (use --gccdir)' % (name, args.gccdir))
+				continue
+			obj = os.path.join(work, name + '.o')
+			out = os.path.join(work, name)
+			subprocess.run(cc + ['-O2', '-fno-pie', '-isystem', os.path.join(ROOT, 'include'),
+				'-c', os.path.join(HERE, name + '.c'), '-o', obj], check=True)
+			cmd = link_command(ld, name, obj, out, args.gccdir)
+			samples = [measure(cmd) for _ in range(args.runs)]
+			wall = statistics.median(s[0] for s in samples)
+			rss = max(s[1] for s in samples)
+			rss = str(rss) if rss > floor else '<%d' % floor
+			print('%-8s %10.1f %10s %12d' % (name, wall * 1000, rss, os.path.getsize(out)))
+	finally:
+		shutil.rmtree(work)
+
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,63 @@
+// A TLS accept loop on libuv and OpenSSL, the shape of a typical vweb service.
+#include <stdlib.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <uv.h>
+
+static SSL_CTX *ctx;
+
+static void on_close(uv_handle_t *handle) {
+	SSL_free(handle->data);
+	free(handle);
+}
+
+static void on_alloc(uv_handle_t *handle, size_t size, uv_buf_t *buf) {
+	buf->base = malloc(size);
+	buf->len = size;
+}
+
+static void on_read(uv_stream_t *client, ssize_t nread, const uv_buf_t *buf) {
+	if (nread > 0) {
+		BIO_write(SSL_get_rbio(client->data), buf->base, (int)nread);
+		SSL_do_handshake(client->data);
+	} else if (nread < 0) {
+		uv_close((uv_handle_t *)client, on_close);
+	}
+	free(buf->base);
+}
+
+static void on_connection(uv_stream_t *server, int status) {
+	uv_tcp_t *client;
+	SSL *ssl;
+	if (status < 0)
+		return;
+	client = malloc(sizeof(*client));
+	uv_tcp_init(server->loop, client);
+	if (uv_accept(server, (uv_stream_t *)client) != 0) {
+		uv_close((uv_handle_t *)client, on_close);
+		return;
+	}
+	ssl = SSL_new(ctx);
+	SSL_set_bio(ssl, BIO_new(BIO_s_mem()), BIO_new(BIO_s_mem()));
+	SSL_set_accept_state(ssl);
+	client->data = ssl;
+	uv_read_start((uv_stream_t *)client, on_alloc, on_read);
+}
+
+int main(void) {
+	uv_loop_t *loop = uv_default_loop();
+	uv_tcp_t server;
+	struct sockaddr_in addr;
+	OPENSSL_init_ssl(0, NULL);
+	ctx = SSL_CTX_new(TLS_server_method());
+	if (ctx == NULL) {
+		ERR_print_errors_fp(stderr);
+		return 1;
+	}
+	uv_tcp_init(loop, &server);
+	uv_ip4_addr("0.0.0.0", 8443, &addr);
+	uv_tcp_bind(&server, (const struct sockaddr *)&addr, 0);
+	if (uv_listen((uv_stream_t *)&server, 128, on_connection) != 0)
+		return 1;
+	return uv_run(loop, UV_RUN_DEFAULT);
+}
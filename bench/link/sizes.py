@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Size report for the static programs, with and without --gc-sections.
+
+Links each static program in this directory twice, once plainly and once
+with --gc-sections, and prints how many bytes of allocated sections each
+archive contributes to the output in both cases, from the linker's map:
+
+    bench/link/sizes.py
+    bench/link/sizes.py --ld ld gcstatic
+
+An archive whose objects were compiled with -ffunction-sections and
+-fdata-sections shrinks with --gc-sections to about what the program
+calls; one compiled without them keeps every function of every member it
+pulls in. Run it before and after rebuilding an archive and compare.
+"""
+
+import argparse
+import collections
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import tempfile
+
+from run import GCCDIR, HERE, PROGRAMS, ROOT, default_cc, default_ld, link_command
+
+# GNU ld: " .text   0x0000000000401000   0x1a /path/libfoo.a(bar.o)", the
+# section name on a line of its own when it is long.
+GNU_INPUT = re.compile(r'^ (?:\S+)?\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(.+?)(?:\((.+)\))?$')
+# lld: "  401000  401000  1a  16  /path/libfoo.a(bar.o):(.text)"
+LLD_INPUT = re.compile(r'^\s+([0-9a-f]+)\s+[0-9a-f]+\s+([0-9a-f]+)\s+\d+\s+(.+?)(?:\((.+)\))?:\(')
+
+
+def read_map(path):
+	"""Returns {input file or archive: bytes in allocated output sections}."""
+	sizes = collections.Counter()
+	with open(path, errors='replace') as f:
+		lines = f.read().splitlines()
+	lld = lines and lines[0].split()[:3] == ['VMA', 'LMA', 'Size']
+	if not lld:
+		# Skip the archive-member and discarded-section lists.
+		start = next((i for i, l in enumerate(lines) if l.startswith('Linker script and memory map')), 0)
+		lines = lines[start:]
+	for line in lines:
+		m = (LLD_INPUT if lld else GNU_INPUT).match(line)
+		if not m:
+			continue
+		addr, size, name = int(m.group(1), 16), int(m.group(2), 16), m.group(3)
+		# Debug and other non-allocated sections sit at address 0.
+		if addr == 0 or size == 0 or not os.path.isabs(name):
+			continue
+		sizes[os.path.relpath(name, ROOT) if name.startswith(ROOT) else os.path.basename(name)] += size
+	return sizes
+
+
+def main():
+	parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+	parser.add_argument('--cc', default=os.environ.get('CC') or default_cc(),
+		help='compiler targeting x86_64 Linux (default: $CC, cc on x86_64 Linux, else clang)')
+	parser.add_argument('--ld', default=os.environ.get('LD') or default_ld(),
+		help='linker (default: $LD, the bundled ld.lld on macOS, else ld.lld)')
+	parser.add_argument('--gccdir', default=GCCDIR,
+		help='directory with crtbeginT.o, libgcc.a and libgcc_eh.a')
+	parser.add_argument('programs', nargs='*', default=[p for p in PROGRAMS if PROGRAMS[p][0]],
+		help='subset to run (default: the static programs)')
+	args = parser.parse_args()
+
+	cc = shlex.split(args.cc)
+	ld = shlex.split(args.ld)
+	work = tempfile.mkdtemp(prefix='vlinuxroot-sizes-')
+	try:
+		for name in args.programs:
+			obj = os.path.join(work, name + '.o')
+			subprocess.run(cc + ['-O2', '-fno-pie', '-ffunction-sections', '-fdata-sections',
+				'-isystem', os.path.join(ROOT, 'include'),
+				'-c', os.path.join(HERE, name + '.c'), '-o', obj], check=True)
+			sizes, files = [], []
+			for gc in (False, True):
+				out = os.path.join(work, name + ('.gc' if gc else ''))
+				cmd = link_command(ld, name, obj, out, args.gccdir)
+				cmd[-2:-2] = ['-Map', out + '.map'] + (['--gc-sections'] if gc else [])
+				subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+				sizes.append(read_map(out + '.map'))
+				files.append(os.path.getsize(out))
+
+			print('%s: %d -> %d bytes with --gc-sections' % (name, files[0], files[1]))
+			print('  %-50s %10s %10s %7s' % ('input', 'plain', 'gc', 'kept'))
+			for f in sorted(sizes[0], key=lambda f: -sizes[0][f]):
+				plain, gc = sizes[0][f], sizes[1][f]
+				print('  %-50s %10d %10d %6.0f%%' % (f, plain, gc, 100.0 * gc / plain))
+	finally:
+		shutil.rmtree(work)
+
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,28 @@
+// Linked with -static: pulls stdio, libm and libpthread out of the archives.
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#define N 4
+
+static double results[N];
+
+static void *worker(void *arg) {
+	long id = (long)arg;
+	double sum = 0;
+	for (int i = 1; i <= 1000; i++)
+		sum += sin(i * (id + 1)) / sqrt(i);
+	results[id] = sum;
+	return NULL;
+}
+
+int main(void) {
+	pthread_t threads[N];
+	for (long i = 0; i < N; i++)
+		pthread_create(&threads[i], NULL, worker, (void *)i);
+	for (int i = 0; i < N; i++) {
+		pthread_join(threads[i], NULL);
+		printf("%d: %f\n", i, results[i]);
+	}
+	return 0;
+}
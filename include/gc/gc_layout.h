@@ -0,0 +1,124 @@
+/*
+ * Precise struct layouts for generated code, on top of gc_typed.h.
+ *
+ * GC_malloc scans every word of an object as a possible pointer, so a
+ * large struct of ints and floats costs the marker as much as an array
+ * of pointers, and any of those numbers that happens to look like a heap
+ * address keeps garbage alive.  This header lets a code generator state
+ * once per type which words hold pointers, and allocate through a
+ * descriptor that is built on first use and cached:
+ *
+ *   typedef struct { string name; u64 id; f64 scores[8]; User *friend; } User;
+ *   GC_LAYOUT(User, GC_LAYOUT_PTR(User, name.str), GC_LAYOUT_PTR(User, friend))
+ *   ...
+ *   User *u = GC_LAYOUT_NEW(User);
+ *   User *all = GC_LAYOUT_NEW_ARRAY(User, n);
+ *
+ * The type must be a single identifier (a typedef name), since it names
+ * the generated functions, and GC_LAYOUT must appear at file scope once
+ * per translation unit that allocates it.  Pointer fields must be word
+ * aligned; a field may name a member of an embedded struct (name.str
+ * above), and GC_LAYOUT_PTRS covers an inline array of pointers.  Types
+ * without any pointer field should be allocated with GC_MALLOC_ATOMIC.
+ *
+ * The offsets are constant expressions, but the descriptor itself is not:
+ * GC_make_descriptor also sets up explicit typing in the collector, and
+ * layouts with a pointer past the 62nd word need a descriptor it keeps
+ * in a table.  It runs once per type (racing threads may each build an
+ * equal one and store it into the cache, a relaxed atomic), after which
+ * allocation is a load and a compare away from GC_malloc_explicitly_typed.
+ * A typed object carries its descriptor in one extra word, so layouts
+ * whose every word may be a pointer go to plain GC_MALLOC instead.
+ */
+
+#ifndef GC_LAYOUT_H
+#define GC_LAYOUT_H
+
+#include <stddef.h>
+
+#ifndef GC_TYPED_H
+# include "gc_typed.h"
+#endif
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/* A run of count pointer-sized words starting at byte offset.          */
+struct GC_layout_field {
+  size_t offset;
+  size_t count;
+};
+
+/* The pointer field f of type T, and an inline array of n pointers.    */
+#define GC_LAYOUT_PTR(T, f) { offsetof(T, f), 1 }
+#define GC_LAYOUT_PTRS(T, f, n) { offsetof(T, f), (n) }
+
+/* Not a descriptor: every word of the type may be a pointer.           */
+#define GC_LAYOUT_ALL_POINTERS (~(GC_descr)0)
+
+/* Builds the descriptor of a type of words words from its fields,      */
+/* using bm (zeroed, GC_BITMAP_SIZE words) as scratch.                  */
+static inline GC_descr GC_layout_make_descr(GC_word *bm, size_t words,
+                                const struct GC_layout_field *fields,
+                                size_t nfields)
+{
+  size_t i, j, covered = 0;
+
+  for (i = 0; i < nfields; i++)
+    for (j = 0; j < fields[i].count; j++) {
+      size_t index = fields[i].offset / sizeof(GC_word) + j;
+
+      if (!GC_get_bit(bm, index)) {
+        GC_set_bit(bm, index);
+        covered++;
+      }
+    }
+  if (covered == words)
+    return GC_LAYOUT_ALL_POINTERS;
+  return GC_make_descriptor(bm, words);
+}
+
+/* Defines GC_layout_descr_T(), which returns the cached descriptor of  */
+/* T, for GC_LAYOUT_NEW and GC_LAYOUT_NEW_ARRAY.  The arguments after   */
+/* T are GC_LAYOUT_PTR and GC_LAYOUT_PTRS entries, at least one.        */
+#define GC_LAYOUT(T, ...) \
+  static inline GC_descr GC_layout_descr_##T(void) \
+  { \
+    static const struct GC_layout_field fields[] = { __VA_ARGS__ }; \
+    static GC_descr descr; \
+    GC_descr d = __atomic_load_n(&descr, __ATOMIC_RELAXED); \
+    if (d == 0) { \
+      GC_word bm[GC_BITMAP_SIZE(T)] = { 0 }; \
+      d = GC_layout_make_descr(bm, GC_WORD_LEN(T), fields, \
+                               sizeof(fields) / sizeof(fields[0])); \
+      __atomic_store_n(&descr, d, __ATOMIC_RELAXED); \
+    } \
+    return d; \
+  }
+
+/* Allocate one cleared T, or a cleared array of n of them.             */
+#define GC_LAYOUT_NEW(T) \
+  ((T *)GC_layout_malloc(sizeof(T), GC_layout_descr_##T()))
+#define GC_LAYOUT_NEW_ARRAY(T, n) \
+  ((T *)GC_layout_calloc((n), sizeof(T), GC_layout_descr_##T()))
+
+static inline void *GC_layout_malloc(size_t lb, GC_descr d)
+{
+  if (d == GC_LAYOUT_ALL_POINTERS)
+    return GC_MALLOC(lb);
+  return GC_MALLOC_EXPLICITLY_TYPED(lb, d);
+}
+
+static inline void *GC_layout_calloc(size_t n, size_t lb, GC_descr d)
+{
+  if (d == GC_LAYOUT_ALL_POINTERS)
+    return lb != 0 && n > ~(size_t)0 / lb ? NULL : GC_MALLOC(n * lb);
+  return GC_CALLOC_EXPLICITLY_TYPED(n, lb, d);
+}
+
+#ifdef __cplusplus
+  } /* extern "C" */
+#endif
+
+#endif /* GC_LAYOUT_H */
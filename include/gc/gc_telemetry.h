@@ -0,0 +1,125 @@
+/*
+ * Per-collection telemetry for libgc, in a shared-memory ring.
+ *
+ * libgc-telemetry.a installs a GC_set_on_collection_event callback that
+ * records, for every collection, the wall time, the stop-the-world pause,
+ * the mark and reclaim phases, heap size and bytes reclaimed (from
+ * GC_get_prof_stats_unsafe) and how busy the marker threads were, into a
+ * fixed-size ring in a file mapped MAP_SHARED.  Another process maps the
+ * same file read-only and samples it without stopping or signalling the
+ * program:
+ *
+ *   GC_INIT();
+ *   GC_telemetry_start("/dev/shm/myservice.gc", 1024);
+ *
+ *   cc ... -lgc-telemetry -lgc -lpthread
+ *
+ * The collector calls the callback with the allocator lock held, so there
+ * is a single writer.  Each record carries a sequence number that is odd
+ * while it is being written; readers copy a record and check the number
+ * before and after, see GC_telemetry_read below, which needs nothing but
+ * this header.  All fields are 64-bit and little-endian, so samplers in
+ * other languages can read the file directly.
+ */
+
+#ifndef GC_TELEMETRY_H
+#define GC_TELEMETRY_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+#define GC_TELEMETRY_MAGIC 0x544d454c45544347ULL /* "GCTELEMT" */
+#define GC_TELEMETRY_VERSION 1
+
+/* One collection.  Times are CLOCK_MONOTONIC nanoseconds.              */
+struct GC_telemetry_record {
+  uint64_t seq;
+            /* 2 * (index + 1) once written, odd while being written.  */
+  uint64_t gc_no;
+            /* Same as GC_get_gc_no() after the collection.             */
+  uint64_t start_ns;
+            /* When the collection began (GC_EVENT_START).              */
+  uint64_t duration_ns;
+            /* From GC_EVENT_START to GC_EVENT_END.                     */
+  uint64_t pause_ns;
+            /* Time the world was stopped, summed over the collection.  */
+  uint64_t mark_ns;
+            /* From GC_EVENT_MARK_START to GC_EVENT_MARK_END.           */
+  uint64_t reclaim_ns;
+            /* From GC_EVENT_RECLAIM_START to GC_EVENT_RECLAIM_END.     */
+  uint64_t heap_size;
+            /* Heap size in bytes after the collection, including       */
+            /* unmapped blocks (heapsize_full of GC_prof_stats_s).      */
+  uint64_t free_bytes;
+            /* Free and unmapped bytes after the collection.            */
+  uint64_t bytes_reclaimed;
+            /* Bytes reclaimed since the previous record: libgc sweeps  */
+            /* lazily, so this is what the previous collection freed   */
+            /* as found by allocation since, plus this one's eager      */
+            /* sweep.  0 in the first record.                           */
+  uint64_t bytes_allocd;
+            /* Bytes allocated since the previous collection.           */
+  uint64_t markers;
+            /* Threads marking, including the initiating one.           */
+  uint64_t mark_cpu_ns;
+            /* CPU time the process spent during the mark phase.  With  */
+            /* the world stopped that is the markers' time, so          */
+            /* mark_cpu_ns / (mark_ns * markers) is their utilization.  */
+  uint64_t reserved[3];
+};
+
+/* The start of the mapped file; capacity records follow it.            */
+struct GC_telemetry_ring {
+  uint64_t magic;
+  uint64_t version;
+  uint64_t record_size;
+            /* sizeof(struct GC_telemetry_record) of the writer.        */
+  uint64_t capacity;
+  uint64_t pid;
+  uint64_t head;
+            /* Number of records written so far; record i (counting    */
+            /* from 0) is at records[i % capacity].                     */
+  uint64_t reserved[2];
+  struct GC_telemetry_record records[1];
+};
+
+/* Creates (or truncates) path, maps it as a ring of capacity records   */
+/* and starts recording.  Call it after GC_INIT.  The previous          */
+/* collection event callback, if any, is still called.  Returns 0, or   */
+/* -1 with errno set.                                                   */
+int GC_telemetry_start(const char * /* path */, unsigned /* capacity */);
+
+/* Stops recording, restores the previous callback and unmaps the ring. */
+/* The file is left in place for samplers to read.                      */
+void GC_telemetry_stop(void);
+
+/* The ring being written, or 0 if recording is off.                    */
+const struct GC_telemetry_ring *GC_telemetry_get_ring(void);
+
+/* Copies record index (counting from 0) out of a ring mapped by any    */
+/* process.  Returns 1 on success, 0 if the record has not been written */
+/* yet or has been overwritten since; a reader that falls behind by     */
+/* more than capacity records loses the oldest ones.                    */
+static __inline__ int GC_telemetry_read(const struct GC_telemetry_ring *ring,
+                                        uint64_t index,
+                                        struct GC_telemetry_record *out)
+{
+  const struct GC_telemetry_record *rec
+        = &ring->records[index % ring->capacity];
+  uint64_t seq = __atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE);
+
+  if (seq != 2 * (index + 1))
+    return 0;
+  __builtin_memcpy(out, rec, sizeof(*out));
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return __atomic_load_n(&rec->seq, __ATOMIC_RELAXED) == seq;
+}
+
+#ifdef __cplusplus
+  } /* extern "C" */
+#endif
+
+#endif /* GC_TELEMETRY_H */
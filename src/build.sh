@@ -0,0 +1,88 @@
+#!/bin/sh
+# Rebuilds the objects in the root that come from src/ rather than from
+# distribution packages. Any compiler that targets x86_64 Linux works:
+#   src/build.sh
+#   CC='clang --target=x86_64-linux-gnu' AR=llvm-ar src/build.sh
+set -e
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+CC=${CC:-cc}
+AR=${AR:-ar}
+# Frame pointers everywhere, so perf and eBPF stack samplers can unwind
+# through these libraries without DWARF.
+CFLAGS="-O2 -fPIC -ffreestanding -fno-omit-frame-pointer -mno-omit-leaf-frame-pointer -isystem $ROOT/include"
+LIBDIR=$ROOT/usr/lib/x86_64-linux-gnu
+GCCDIR=$ROOT/usr/lib/gcc/x86_64-linux-gnu/12
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+# Scrt1.o (PIE) and rcrt1.o (static-pie) share one start file.
+$CC -c "$ROOT/src/csu/start.S" -o "$LIBDIR/Scrt1.o"
+cp "$LIBDIR/Scrt1.o" "$LIBDIR/rcrt1.o"
+
+# _dl_find_object fallback for GCC 12's libgcc_eh.a on glibc 2.31.
+$CC $CFLAGS -c "$ROOT/src/libgcc/dl_find_object.c" -o "$TMP/dl_find_object.o"
+$AR rcs "$GCCDIR/libgcc_eh.a" "$TMP/dl_find_object.o"
+
+# librt: librt.so.1 with the glibc 2.31 symbol versions, and librt.a.
+$CC $CFLAGS -DSHARED -c "$ROOT/src/librt/rt.c" -o "$TMP/rt-shared.o"
+$CC -shared -nostdlib --sysroot="$ROOT" -Wl,-soname,librt.so.1 \
+	-Wl,--version-script="$ROOT/src/librt/librt.map" "$TMP/rt-shared.o" \
+	-L"$LIBDIR" -L"$ROOT/lib/x86_64-linux-gnu" -lpthread -lc -o "$ROOT/lib/x86_64-linux-gnu/librt.so.1"
+$CC $CFLAGS -c "$ROOT/src/librt/rt.c" -o "$TMP/rt.o"
+rm -f "$LIBDIR/librt.a"
+$AR rcs "$LIBDIR/librt.a" "$TMP/rt.o"
+
+# libanl: libanl.so.1 with the glibc 2.31 symbol versions, and libanl.a.
+$CC $CFLAGS -c "$ROOT/src/libanl/anl.c" -o "$TMP/anl.o"
+$CC -shared -nostdlib --sysroot="$ROOT" -Wl,-soname,libanl.so.1 \
+	-Wl,--version-script="$ROOT/src/libanl/libanl.map" "$TMP/anl.o" \
+	-L"$LIBDIR" -L"$ROOT/lib/x86_64-linux-gnu" -lpthread -lc -o "$ROOT/lib/x86_64-linux-gnu/libanl.so.1"
+rm -f "$LIBDIR/libanl.a"
+$AR rcs "$LIBDIR/libanl.a" "$TMP/anl.o"
+
+# libgc-telemetry.a: per-collection records for include/gc/gc_telemetry.h.
+$CC $CFLAGS -c "$ROOT/src/gc-telemetry/telemetry.c" -o "$TMP/telemetry.o"
+rm -f "$LIBDIR/libgc-telemetry.a"
+$AR rcs "$LIBDIR/libgc-telemetry.a" "$TMP/telemetry.o"
+
+# The libgc variants below are libgc.a with some calls or routines in
+# os_dep.o renamed, and a member that defines the new names.
+OBJCOPY=${OBJCOPY:-objcopy}
+OBJDUMP=${OBJDUMP:-objdump}
+
+# libgc-hugepage.a: libgc.a with THP/hugetlbfs-backed heap sections.
+# Only libgc's own sbrk and mmap calls are redirected.
+mkdir "$TMP/hugepage"
+(cd "$TMP/hugepage" && $AR x "$LIBDIR/libgc.a" os_dep.o)
+$OBJCOPY --redefine-sym sbrk=GC_hugepage_sbrk --redefine-sym mmap=GC_hugepage_mmap \
+	"$TMP/hugepage/os_dep.o"
+$CC $CFLAGS -c "$ROOT/src/gc-hugepage/hugepage.c" -o "$TMP/hugepage/hugepage.o"
+cp "$LIBDIR/libgc.a" "$TMP/libgc-hugepage.a"
+$AR r "$TMP/libgc-hugepage.a" "$TMP/hugepage/os_dep.o" "$TMP/hugepage/hugepage.o"
+mv "$TMP/libgc-hugepage.a" "$LIBDIR/libgc-hugepage.a"
+
+# libgc-uffd.a: libgc.a with userfaultfd dirty bits for incremental mode.
+# The mprotect routines in os_dep.o stay as the fallback, under new names.
+# uffd.c reads GC_heap_sects, which is at HEAP_SECTS in GC_arrays in the
+# shipped libgc.a: GC_protect_heap loads its address (the relocation is
+# 4 less, for the rest of the lea) and walks it in steps of 16 bytes,
+# hs_start then hs_bytes.  Stop if a rebuilt libgc.a no longer does.
+HEAP_SECTS=0x168e0
+mkdir "$TMP/uffd"
+(cd "$TMP/uffd" && $AR x "$LIBDIR/libgc.a" os_dep.o)
+$OBJDUMP -dr "$TMP/uffd/os_dep.o" | sed -n '/<GC_protect_heap>:/,/^$/p' > "$TMP/uffd/protect_heap.s"
+for pattern in "R_X86_64_PC32[[:space:]]*GC_arrays+$(printf '0x%x' $((HEAP_SECTS - 4)))\$" \
+	'add[[:space:]]*\$0x10,%rbx$' 'mov[[:space:]]*(%rbx),' 'mov[[:space:]]*0x8(%rbx),'; do
+	if ! grep -q "$pattern" "$TMP/uffd/protect_heap.s"; then
+		echo "$0: GC_heap_sects is not at GC_arrays+$HEAP_SECTS in libgc.a; update HEAP_SECTS" >&2
+		exit 1
+	fi
+done
+for sym in dirty_init read_dirty page_was_dirty remove_protection incremental_protection_needs; do
+	$OBJCOPY --redefine-sym GC_$sym=GC_mprotect_$sym "$TMP/uffd/os_dep.o"
+done
+$CC $CFLAGS -DGC_HEAP_SECTS_OFFSET=$HEAP_SECTS -c "$ROOT/src/gc-uffd/uffd.c" -o "$TMP/uffd/uffd.o"
+cp "$LIBDIR/libgc.a" "$TMP/libgc-uffd.a"
+$AR r "$TMP/libgc-uffd.a" "$TMP/uffd/os_dep.o" "$TMP/uffd/uffd.o"
+mv "$TMP/libgc-uffd.a" "$LIBDIR/libgc-uffd.a"
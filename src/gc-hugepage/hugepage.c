@@ -0,0 +1,156 @@
+/* libgc-hugepage: huge pages for the libgc heap.
+
+   The shipped libgc gets its heap from sbrk (and from mmap if sbrk
+   fails) in sections sized to the heap, and never asks for huge pages,
+   so with THP in "madvise" mode marking a large heap walks it through
+   4 KiB TLB entries.  libgc-hugepage.a is libgc.a with the sbrk and mmap
+   calls in os_dep.o, the only member that makes them, renamed to
+   GC_hugepage_sbrk and GC_hugepage_mmap, plus this file, which defines
+   those.  The rest of the program keeps libc's:
+
+     cc ... -lgc-hugepage -lpthread    (instead of -lgc)
+
+   Growing requests of at least 2 MiB start on a 2 MiB boundary and are
+   advised MADV_HUGEPAGE; smaller ones are advised too, so khugepaged can
+   collapse them once neighbouring sections fill a huge page.  Mappings
+   at a given address are passed through.
+
+   GC_HUGEPAGES in the environment selects the mode when the first request
+   comes in:
+     thp (default)  align and madvise, as above;
+     hugetlb        serve requests of 2 MiB or more from MAP_HUGETLB
+                    (reserved pages, /proc/sys/vm/nr_hugepages), falling
+                    back to thp when none are left.  libgc must not unmap
+                    or protect parts of such sections: set
+                    GC_UNMAP_THRESHOLD=0 and don't enable incremental mode;
+     off            pass everything through.  */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define HUGE_PAGE ((uintptr_t)2 << 20)
+#define PAGE ((uintptr_t)4096)
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << 26)
+#endif
+
+enum { MODE_UNSET, MODE_OFF, MODE_THP, MODE_HUGETLB };
+
+static int mode;
+
+static int get_mode(void)
+{
+	/* Racing threads compute the same value.  */
+	if (__atomic_load_n(&mode, __ATOMIC_RELAXED) == MODE_UNSET) {
+		const char *env = getenv("GC_HUGEPAGES");
+		int m = MODE_THP;
+
+		if (env != NULL && strcmp(env, "off") == 0)
+			m = MODE_OFF;
+		else if (env != NULL && strcmp(env, "hugetlb") == 0)
+			m = MODE_HUGETLB;
+		__atomic_store_n(&mode, m, __ATOMIC_RELAXED);
+	}
+	return mode;
+}
+
+static uintptr_t align_up(uintptr_t x, uintptr_t a)
+{
+	return (x + a - 1) & ~(a - 1);
+}
+
+/* Advises the whole pages of [p, p + len).  Failure only costs the
+   huge pages, so it is ignored.  */
+static void advise(void *p, size_t len)
+{
+	uintptr_t start = align_up((uintptr_t)p, PAGE);
+	uintptr_t end = ((uintptr_t)p + len) & ~(PAGE - 1);
+
+	if (end > start) {
+		int saved = errno;
+
+		madvise((void *)start, end - start, MADV_HUGEPAGE);
+		errno = saved;
+	}
+}
+
+static void *map_hugetlb(size_t len, int prot, int flags)
+{
+	int saved = errno;
+	void *p = mmap(NULL, align_up(len, HUGE_PAGE), prot, flags | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+
+	errno = saved;
+	return p;
+}
+
+void *GC_hugepage_sbrk(intptr_t increment)
+{
+	int m = increment > 0 ? get_mode() : MODE_OFF;
+	intptr_t pad = 0;
+	void *p;
+
+	if (m == MODE_OFF)
+		return sbrk(increment);
+	if ((uintptr_t)increment >= HUGE_PAGE) {
+		if (m == MODE_HUGETLB) {
+			/* libgc doesn't need its sections contiguous.  */
+			p = map_hugetlb((size_t)increment, PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS);
+			if (p != MAP_FAILED)
+				return p;
+		}
+		p = sbrk(0);
+		if (p != (void *)-1 && ((uintptr_t)p & (HUGE_PAGE - 1)) != 0) {
+			pad = (intptr_t)(align_up((uintptr_t)p, HUGE_PAGE) - (uintptr_t)p);
+			if (sbrk(pad) == (void *)-1)
+				pad = 0;
+		}
+	}
+	p = sbrk(increment);
+	if (p == (void *)-1) {
+		/* Give the padding back, keeping sbrk's errno.  */
+		int saved = errno;
+
+		if (pad != 0)
+			sbrk(-pad);
+		errno = saved;
+		return p;
+	}
+	advise(p, (size_t)increment);
+	return p;
+}
+
+void *GC_hugepage_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t offset)
+{
+	uintptr_t start, aligned;
+	size_t size;
+	void *p;
+
+	if ((flags & (MAP_ANONYMOUS | MAP_FIXED | MAP_SHARED | MAP_HUGETLB)) != MAP_ANONYMOUS
+	    || addr != NULL || len < HUGE_PAGE || get_mode() == MODE_OFF)
+		return mmap(addr, len, prot, flags, fd, offset);
+	if (mode == MODE_HUGETLB) {
+		p = map_hugetlb(len, prot, flags);
+		if (p != MAP_FAILED)
+			return p;
+	}
+
+	/* Over-map by a huge page, then trim to a 2 MiB-aligned range of
+	   exactly len bytes, so munmap(p, len) still releases all of it.  */
+	size = align_up(len, PAGE);
+	p = mmap(NULL, size + HUGE_PAGE, prot, flags, fd, offset);
+	if (p == MAP_FAILED)
+		return mmap(NULL, len, prot, flags, fd, offset);
+	start = (uintptr_t)p;
+	aligned = align_up(start, HUGE_PAGE);
+	if (aligned > start)
+		munmap(p, aligned - start);
+	munmap((void *)(aligned + size), start + HUGE_PAGE - aligned);
+	advise((void *)aligned, len);
+	return (void *)aligned;
+}
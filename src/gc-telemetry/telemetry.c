@@ -0,0 +1,193 @@
+/* libgc-telemetry: per-collection records in a shared-memory ring.
+
+   See include/gc/gc_telemetry.h.  Everything here runs from the
+   collection event callback, with the allocator lock held and often the
+   world stopped, so it must not allocate from the collector or take
+   locks: it reads clocks and writes to the mapped ring, nothing else.  */
+
+#define _GNU_SOURCE
+#define GC_THREADS
+#define GC_NO_THREAD_REDIRECTS
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <gc/gc.h>
+#include <gc/gc_telemetry.h>
+
+static struct GC_telemetry_ring *ring;
+static size_t ring_size;
+static GC_on_collection_event_proc prev_event;
+
+/* The collection in progress.  */
+static struct GC_telemetry_record cur;
+static uint64_t stop_ns, mark_start_ns, mark_start_cpu_ns, reclaim_start_ns;
+/* Bytes reclaimed since GC_INIT as of the previous record.  */
+static uint64_t reclaimed_total;
+
+static uint64_t now(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/* The allocator lock is already held: GC_get_prof_stats and the
+   GC_get_*_bytes getters would take it again.  */
+static void read_stats(struct GC_prof_stats_s *stats)
+{
+	memset(stats, 0xff, sizeof(*stats));
+	GC_get_prof_stats_unsafe(stats, sizeof(*stats));
+}
+
+static void publish(void)
+{
+	struct GC_prof_stats_s stats;
+	struct GC_telemetry_record *rec;
+	uint64_t index = ring->head;
+	uint64_t total;
+
+	read_stats(&stats);
+	cur.gc_no = stats.gc_no;
+	cur.heap_size = stats.heapsize_full;
+	cur.free_bytes = stats.free_bytes_full;
+	/* libgc sweeps lazily, so what a collection frees is mostly found
+	   while the program allocates afterwards: count everything found
+	   since the previous record.  */
+	total = stats.reclaimed_bytes_before_gc + stats.bytes_reclaimed_since_gc;
+	if (stats.reclaimed_bytes_before_gc != (GC_word)-1) {
+		cur.bytes_reclaimed = reclaimed_total != 0 ? total - reclaimed_total : 0;
+		reclaimed_total = total;
+	}
+	cur.markers = stats.markers_m1 + 1;
+
+	rec = &ring->records[index % ring->capacity];
+	__atomic_store_n(&rec->seq, 2 * index + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	cur.seq = 2 * index + 1;
+	memcpy(rec, &cur, sizeof(cur));
+	__atomic_store_n(&rec->seq, 2 * (index + 1), __ATOMIC_RELEASE);
+	__atomic_store_n(&ring->head, index + 1, __ATOMIC_RELEASE);
+}
+
+static void GC_CALLBACK on_event(GC_EventType event)
+{
+	struct GC_prof_stats_s stats;
+	uint64_t t;
+
+	if (ring != NULL) {
+		t = now(CLOCK_MONOTONIC);
+		switch (event) {
+		case GC_EVENT_START:
+			memset(&cur, 0, sizeof(cur));
+			cur.start_ns = t;
+			/* Taken before the collection resets it.  */
+			read_stats(&stats);
+			cur.bytes_allocd = stats.bytes_allocd_since_gc;
+			break;
+		case GC_EVENT_PRE_STOP_WORLD:
+			stop_ns = t;
+			break;
+		case GC_EVENT_POST_START_WORLD:
+			if (stop_ns != 0)
+				cur.pause_ns += t - stop_ns;
+			stop_ns = 0;
+			break;
+		case GC_EVENT_MARK_START:
+			mark_start_ns = t;
+			mark_start_cpu_ns = now(CLOCK_PROCESS_CPUTIME_ID);
+			break;
+		case GC_EVENT_MARK_END:
+			cur.mark_ns += t - mark_start_ns;
+			cur.mark_cpu_ns += now(CLOCK_PROCESS_CPUTIME_ID) - mark_start_cpu_ns;
+			break;
+		case GC_EVENT_RECLAIM_START:
+			reclaim_start_ns = t;
+			break;
+		case GC_EVENT_RECLAIM_END:
+			cur.reclaim_ns += t - reclaim_start_ns;
+			break;
+		case GC_EVENT_END:
+			/* A collection abandoned before it started (or one that
+			   was already in progress when recording began) has
+			   nothing to report.  */
+			if (cur.start_ns != 0) {
+				cur.duration_ns = t - cur.start_ns;
+				publish();
+				cur.start_ns = 0;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	if (prev_event != 0)
+		prev_event(event);
+}
+
+int GC_telemetry_start(const char *path, unsigned capacity)
+{
+	struct GC_telemetry_ring *r;
+	size_t size;
+	int fd;
+
+	if (capacity == 0 || ring != NULL) {
+		errno = capacity == 0 ? EINVAL : EBUSY;
+		return -1;
+	}
+	size = offsetof(struct GC_telemetry_ring, records)
+	       + (size_t)capacity * sizeof(struct GC_telemetry_record);
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0)
+		return -1;
+	if (ftruncate(fd, (off_t)size) != 0) {
+		int saved = errno;
+
+		close(fd);
+		errno = saved;
+		return -1;
+	}
+	r = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (r == MAP_FAILED)
+		return -1;
+
+	r->version = GC_TELEMETRY_VERSION;
+	r->record_size = sizeof(struct GC_telemetry_record);
+	r->capacity = capacity;
+	r->pid = (uint64_t)getpid();
+	r->head = 0;
+	/* Samplers check the magic last.  */
+	__atomic_store_n(&r->magic, GC_TELEMETRY_MAGIC, __ATOMIC_RELEASE);
+
+	ring_size = size;
+	reclaimed_total = 0;
+	prev_event = GC_get_on_collection_event();
+	/* The setter takes the allocator lock, so no collection sees a
+	   half-initialized ring.  */
+	ring = r;
+	GC_set_on_collection_event(on_event);
+	return 0;
+}
+
+void GC_telemetry_stop(void)
+{
+	struct GC_telemetry_ring *r = ring;
+
+	if (r == NULL)
+		return;
+	GC_set_on_collection_event(prev_event);
+	ring = NULL;
+	prev_event = 0;
+	munmap(r, ring_size);
+}
+
+const struct GC_telemetry_ring *GC_telemetry_get_ring(void)
+{
+	return ring;
+}
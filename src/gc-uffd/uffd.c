@@ -0,0 +1,383 @@
+/* libgc-uffd: dirty bits for incremental collection from userfaultfd.
+
+   The shipped libgc finds the pages written since the last look (its
+   "virtual dirty bits") by write-protecting the heap with mprotect and
+   taking a SIGSEGV on the first write to each page.  libgc-uffd.a is
+   libgc.a with those routines in os_dep.o renamed to GC_mprotect_*, plus
+   this file, which defines them again on top of asynchronous userfaultfd
+   write protection (Linux 6.7 and later):
+
+     cc ... -lgc-uffd -lpthread    (instead of -lgc)
+
+   The heap sections in GC_heap_sects, and nothing else, are registered
+   with a userfaultfd in UFFDIO_REGISTER_MODE_WP with
+   UFFD_FEATURE_WP_ASYNC, so the kernel resolves the first write to a
+   protected page itself, with a minor fault and no signal.  Each
+   GC_read_dirty runs PAGEMAP_SCAN over the sections, which returns the
+   pages written since the previous scan and protects them again,
+   atomically, so no write is lost however the mutator threads race with
+   it.  Nothing is protected with mprotect, so system calls may write
+   into the heap (GC_incremental_protection_needs returns
+   GC_PROTECTS_NONE).
+
+   Without WP_ASYNC (or with GC_VDB=mprotect in the environment) the
+   mprotect routines are used as before.  */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/userfaultfd.h>
+
+#include <gc/gc.h>
+
+/* Newer than the root's kernel headers.  */
+#ifndef UFFD_USER_MODE_ONLY
+#define UFFD_USER_MODE_ONLY 1
+#endif
+#ifndef UFFD_FEATURE_WP_HUGETLBFS_SHMEM
+#define UFFD_FEATURE_WP_HUGETLBFS_SHMEM (1 << 12)
+#endif
+#ifndef UFFD_FEATURE_WP_UNPOPULATED
+#define UFFD_FEATURE_WP_UNPOPULATED (1 << 13)
+#endif
+#ifndef UFFD_FEATURE_WP_ASYNC
+#define UFFD_FEATURE_WP_ASYNC (1 << 15)
+#endif
+#ifndef PAGEMAP_SCAN
+struct page_region {
+	uint64_t start;
+	uint64_t end;
+	uint64_t categories;
+};
+
+struct pm_scan_arg {
+	uint64_t size;
+	uint64_t flags;
+	uint64_t start;
+	uint64_t end;
+	uint64_t walk_end;
+	uint64_t vec;
+	uint64_t vec_len;
+	uint64_t max_pages;
+	uint64_t category_inverted;
+	uint64_t category_mask;
+	uint64_t category_anyof_mask;
+	uint64_t return_mask;
+};
+
+#define PAGE_IS_WRITTEN (1 << 1)
+#define PM_SCAN_WP_MATCHING (1 << 0)
+#define PAGEMAP_SCAN _IOWR('f', 16, struct pm_scan_arg)
+#endif
+
+/* libgc's heap block size, which is also the page size it tracks.  */
+#define PAGE ((uintptr_t)4096)
+
+/* libgc internals, as libgc.a was built.  GC_heap_sects is a member of
+   GC_arrays; build.sh passes its offset after checking it, and the
+   HeapSect layout, against GC_protect_heap in os_dep.o.  */
+#ifndef GC_HEAP_SECTS_OFFSET
+#error "GC_HEAP_SECTS_OFFSET is not set: build with src/build.sh"
+#endif
+struct hblk;
+struct HeapSect {
+	void *hs_start;
+	size_t hs_bytes;
+};
+extern char GC_arrays[];
+#define GC_heap_sects ((struct HeapSect *)(GC_arrays + GC_HEAP_SECTS_OFFSET))
+extern GC_word GC_n_heap_sects;
+extern void *GC_least_plausible_heap_addr;
+extern void *GC_greatest_plausible_heap_addr;
+extern int GC_mprotect_dirty_init(void);
+extern void GC_mprotect_read_dirty(void);
+extern int GC_mprotect_page_was_dirty(struct hblk *);
+extern void GC_mprotect_remove_protection(struct hblk *, GC_word, int);
+extern int GC_mprotect_incremental_protection_needs(void);
+
+enum { MODE_UNSET, MODE_MPROTECT, MODE_UFFD };
+
+/* Everything below is used with the allocator lock held.  */
+static int mode;
+static int uffd = -1, pagemap = -1;
+static pid_t fds_pid;
+/* The heap sections registered so far, GC_heap_sects[0..registered_sects).  */
+static GC_word registered_sects;
+/* Something failed: report every heap page dirty from now on.  */
+static int all_dirty;
+/* A registered heap section, and where its bits start in dirty.  */
+struct sect {
+	uintptr_t start, end;
+	size_t bit;
+};
+
+/* The registered sections, sorted by address, and a bit per page of
+   each, set for the pages written as of the last GC_read_dirty (when
+   scanned is set).  */
+static struct sect *sects;
+static size_t nsects, sects_size;
+static unsigned long *dirty;
+static size_t dirty_pages, dirty_size;
+static int scanned;
+static struct page_region regions[512];
+
+/* Opens the userfaultfd and /proc/self/pagemap, which both belong to the
+   process that opened them.  */
+static int open_fds(void)
+{
+	struct uffdio_api api;
+
+	pagemap = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+	if (pagemap < 0)
+		return 0;
+	uffd = (int)syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY);
+	if (uffd < 0)
+		goto fail;
+	memset(&api, 0, sizeof(api));
+	api.api = UFFD_API;
+	if (ioctl(uffd, UFFDIO_API, &api) != 0
+	    || (api.features & (UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED))
+	       != (UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED))
+		goto fail;
+	/* A file descriptor takes UFFDIO_API once: reopen it to enable.  */
+	close(uffd);
+	uffd = (int)syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY);
+	if (uffd < 0)
+		goto fail;
+	api.features &= UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED
+			| UFFD_FEATURE_WP_HUGETLBFS_SHMEM;
+	api.api = UFFD_API;
+	if (ioctl(uffd, UFFDIO_API, &api) != 0)
+		goto fail;
+	fds_pid = getpid();
+	registered_sects = nsects = dirty_pages = 0;
+	return 1;
+fail:
+	if (uffd >= 0)
+		close(uffd);
+	close(pagemap);
+	uffd = pagemap = -1;
+	return 0;
+}
+
+static int choose_mode(void)
+{
+	if (mode == MODE_UNSET) {
+		const char *env = getenv("GC_VDB");
+
+		mode = MODE_MPROTECT;
+		if ((env == NULL || strcmp(env, "mprotect") != 0) && open_fds())
+			mode = MODE_UFFD;
+	}
+	return mode;
+}
+
+static int register_range(uintptr_t start, uintptr_t end)
+{
+	struct uffdio_register reg;
+
+	memset(&reg, 0, sizeof(reg));
+	reg.range.start = start;
+	reg.range.len = end - start;
+	reg.mode = UFFDIO_REGISTER_MODE_WP;
+	return ioctl(uffd, UFFDIO_REGISTER, &reg) == 0;
+}
+
+/* Returns a mapping of at least size bytes that starts with the first
+   keep bytes of *p, which it replaces, or NULL.  */
+static void *grow(void *p, size_t *p_size, size_t size, size_t keep)
+{
+	void *q;
+
+	if (size <= *p_size)
+		return p;
+	size = (size + 0xffff) & ~(size_t)0xffff;
+	q = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (q == MAP_FAILED)
+		return NULL;
+	if (p != NULL) {
+		memcpy(q, p, keep);
+		munmap(p, *p_size);
+	}
+	*p_size = size;
+	return q;
+}
+
+static int add_sect(uintptr_t start, uintptr_t end)
+{
+	struct sect *q = grow(sects, &sects_size, (nsects + 1) * sizeof(*sects),
+			      nsects * sizeof(*sects));
+	size_t i;
+
+	if (q == NULL)
+		return 0;
+	sects = q;
+	for (i = nsects; i > 0 && sects[i - 1].start > start; i--)
+		sects[i] = sects[i - 1];
+	sects[i].start = start;
+	sects[i].end = end;
+	sects[i].bit = dirty_pages;
+	nsects++;
+	dirty_pages += (end - start) / PAGE;
+	return 1;
+}
+
+static const struct sect *find_sect(uintptr_t p)
+{
+	size_t lo = 0, hi = nsects;
+
+	while (hi - lo > 1) {
+		size_t mid = (lo + hi) / 2;
+
+		if (sects[mid].start <= p)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	if (nsects == 0 || p < sects[lo].start || p >= sects[lo].end)
+		return NULL;
+	return &sects[lo];
+}
+
+/* Registers the heap sections libgc added since the last call, and
+   nothing else in the address space.  PAGEMAP_SCAN silently skips
+   unregistered mappings, so a section that could not be registered (or
+   does not look like one) turns dirty tracking off.  Its pages count as
+   written until the next scan protects them.  */
+static void register_heap(uintptr_t lo, uintptr_t hi)
+{
+	for (; registered_sects < GC_n_heap_sects; registered_sects++) {
+		uintptr_t start = (uintptr_t)GC_heap_sects[registered_sects].hs_start;
+		uintptr_t end = start + GC_heap_sects[registered_sects].hs_bytes;
+
+		start &= ~(PAGE - 1);
+		end = (end + PAGE - 1) & ~(PAGE - 1);
+		if (start < lo || end > hi || start >= end || !register_range(start, end)
+		    || !add_sect(start, end)) {
+			all_dirty = 1;
+			return;
+		}
+	}
+}
+
+/* Sets the bits of the pages of s written since the last scan, and
+   protects them again.  */
+static int scan_sect(const struct sect *s)
+{
+	struct pm_scan_arg arg;
+	long n;
+
+	memset(&arg, 0, sizeof(arg));
+	arg.size = sizeof(arg);
+	arg.flags = PM_SCAN_WP_MATCHING;
+	arg.start = s->start;
+	arg.end = s->end;
+	arg.vec = (uintptr_t)regions;
+	arg.vec_len = sizeof(regions) / sizeof(regions[0]);
+	arg.category_mask = PAGE_IS_WRITTEN;
+	arg.return_mask = PAGE_IS_WRITTEN;
+	for (;;) {
+		n = ioctl(pagemap, PAGEMAP_SCAN, &arg);
+		if (n < 0)
+			return 0;
+		for (long i = 0; i < n; i++)
+			for (uintptr_t p = regions[i].start; p < regions[i].end; p += PAGE) {
+				size_t bit = s->bit + (p - s->start) / PAGE;
+
+				dirty[bit / (8 * sizeof(long))] |= 1UL << bit % (8 * sizeof(long));
+			}
+		/* The vector filled up before the end of the range.  */
+		if (arg.walk_end >= s->end)
+			return 1;
+		arg.start = arg.walk_end;
+	}
+}
+
+static void uffd_read_dirty(void)
+{
+	uintptr_t lo = (uintptr_t)GC_least_plausible_heap_addr & ~(PAGE - 1);
+	uintptr_t hi = ((uintptr_t)GC_greatest_plausible_heap_addr + PAGE - 1) & ~(PAGE - 1);
+	size_t bytes;
+	void *q;
+
+	/* A child of fork has the parent's file descriptors and none of its
+	   registrations.  Its copies of the pages are not write-protected,
+	   so they all count as written until it has registered its own.  */
+	if (fds_pid != getpid() && !all_dirty) {
+		close(uffd);
+		close(pagemap);
+		if (!open_fds())
+			all_dirty = 1;
+	}
+	scanned = 0;
+	if (all_dirty || hi <= lo)
+		return;
+	register_heap(lo, hi);
+	if (all_dirty)
+		return;
+	bytes = (dirty_pages + 8 * sizeof(long) - 1) / (8 * sizeof(long)) * sizeof(long);
+	q = grow(dirty, &dirty_size, bytes, 0);
+	if (q == NULL) {
+		all_dirty = 1;
+		return;
+	}
+	dirty = q;
+	memset(dirty, 0, bytes);
+	for (size_t i = 0; i < nsects; i++)
+		if (!scan_sect(&sects[i])) {
+			all_dirty = 1;
+			return;
+		}
+	scanned = 1;
+}
+
+int GC_dirty_init(void)
+{
+	if (choose_mode() == MODE_MPROTECT)
+		return GC_mprotect_dirty_init();
+	return 1;
+}
+
+void GC_read_dirty(void)
+{
+	if (mode == MODE_UFFD)
+		uffd_read_dirty();
+	else
+		GC_mprotect_read_dirty();
+}
+
+int GC_page_was_dirty(struct hblk *h)
+{
+	const struct sect *s;
+	size_t bit;
+
+	if (mode != MODE_UFFD)
+		return GC_mprotect_page_was_dirty(h);
+	/* Pages outside the heap (roots), and heap sections added since
+	   the last scan, are always scanned.  */
+	s = scanned ? find_sect((uintptr_t)h) : NULL;
+	if (s == NULL)
+		return 1;
+	bit = s->bit + ((uintptr_t)h - s->start) / PAGE;
+	return (int)(dirty[bit / (8 * sizeof(long))] >> bit % (8 * sizeof(long)) & 1);
+}
+
+void GC_remove_protection(struct hblk *h, GC_word nblocks, int is_ptrfree)
+{
+	if (mode != MODE_UFFD)
+		GC_mprotect_remove_protection(h, nblocks, is_ptrfree);
+}
+
+int GC_incremental_protection_needs(void)
+{
+	if (mode == MODE_UFFD)
+		return GC_PROTECTS_NONE;
+	return GC_mprotect_incremental_protection_needs();
+}
@@ -0,0 +1,298 @@
+/* libanl for the root.
+
+   getaddrinfo_a and friends, with the x86_64 libanl.so.1 symbol versions
+   of glibc 2.31, which the root does not ship.  Like glibc, requests are
+   handed to a small pool of threads that call the blocking getaddrinfo,
+   so batches of lookups resolve in parallel; a dynamic binary uses the
+   target's real libanl at run time.  */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/* glibc's default for the number of resolver threads.  */
+#define MAX_THREADS 20
+/* Seconds an idle thread waits for work before it exits.  */
+#define IDLE_TIMEOUT 1
+
+struct batch {
+	int pending;
+	int nowait;
+	struct sigevent sig;
+};
+
+struct request {
+	struct gaicb *gaicb;
+	struct batch *batch;
+	struct request *next;
+};
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static struct request *queue_head, *queue_tail;
+static int nthreads, nidle;
+
+static void *notify_thread(void *arg)
+{
+	struct sigevent *sig = arg;
+
+	sig->sigev_notify_function(sig->sigev_value);
+	free(sig);
+	return NULL;
+}
+
+static void notify(const struct sigevent *sig)
+{
+	if (sig->sigev_notify == SIGEV_SIGNAL) {
+		siginfo_t info;
+
+		memset(&info, 0, sizeof(info));
+		info.si_signo = sig->sigev_signo;
+		info.si_code = SI_ASYNCNL;
+		info.si_pid = getpid();
+		info.si_uid = getuid();
+		info.si_value = sig->sigev_value;
+		syscall(SYS_rt_sigqueueinfo, info.si_pid, info.si_signo, &info);
+	} else if (sig->sigev_notify == SIGEV_THREAD) {
+		struct sigevent *copy = malloc(sizeof(*copy));
+		pthread_attr_t attr;
+		pthread_t thread;
+		size_t stacksize;
+
+		if (copy == NULL)
+			return;
+		*copy = *sig;
+		/* pthread_attr_t is opaque and may own memory, so it is not
+		   copied: only the caller's stack size is taken over.  */
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+		if (sig->sigev_notify_attributes != NULL
+		    && pthread_attr_getstacksize(sig->sigev_notify_attributes, &stacksize) == 0)
+			pthread_attr_setstacksize(&attr, stacksize);
+		if (pthread_create(&thread, &attr, notify_thread, copy) != 0)
+			free(copy);
+		pthread_attr_destroy(&attr);
+	}
+}
+
+/* Called with lock held once a request is finished or canceled.  */
+static void finish(struct request *req, int ret)
+{
+	struct batch *batch = req->batch;
+
+	req->gaicb->__return = ret;
+	if (--batch->pending == 0 && batch->nowait) {
+		notify(&batch->sig);
+		free(batch);
+	}
+	free(req);
+	pthread_cond_broadcast(&done_cond);
+}
+
+static void *worker(void *arg)
+{
+	(void)arg;
+	pthread_mutex_lock(&lock);
+	for (;;) {
+		struct request *req;
+		struct gaicb *gaicb;
+		struct timespec deadline;
+		int ret;
+
+		while (queue_head == NULL) {
+			clock_gettime(CLOCK_REALTIME, &deadline);
+			deadline.tv_sec += IDLE_TIMEOUT;
+			nidle++;
+			ret = pthread_cond_timedwait(&work_cond, &lock, &deadline);
+			nidle--;
+			if (ret == ETIMEDOUT && queue_head == NULL) {
+				nthreads--;
+				pthread_mutex_unlock(&lock);
+				return NULL;
+			}
+		}
+		req = queue_head;
+		queue_head = req->next;
+		if (queue_head == NULL)
+			queue_tail = NULL;
+		gaicb = req->gaicb;
+		pthread_mutex_unlock(&lock);
+
+		ret = getaddrinfo(gaicb->ar_name, gaicb->ar_service,
+				  gaicb->ar_request, &gaicb->ar_result);
+
+		pthread_mutex_lock(&lock);
+		finish(req, ret);
+	}
+}
+
+/* Called with lock held.  */
+static int enqueue(struct gaicb *gaicb, struct batch *batch)
+{
+	struct request *req = malloc(sizeof(*req));
+
+	if (req == NULL)
+		return EAI_MEMORY;
+	req->gaicb = gaicb;
+	req->batch = batch;
+	req->next = NULL;
+	gaicb->__return = EAI_INPROGRESS;
+	if (queue_tail != NULL)
+		queue_tail->next = req;
+	else
+		queue_head = req;
+	queue_tail = req;
+	batch->pending++;
+
+	if (nidle > 0) {
+		pthread_cond_signal(&work_cond);
+	} else if (nthreads < MAX_THREADS) {
+		pthread_attr_t attr;
+		pthread_t thread;
+
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+		if (pthread_create(&thread, &attr, worker, NULL) == 0)
+			nthreads++;
+		pthread_attr_destroy(&attr);
+		/* With no thread at all the request would never run.  */
+		if (nthreads == 0) {
+			queue_head = queue_tail = NULL;
+			batch->pending--;
+			gaicb->__return = EAI_AGAIN;
+			free(req);
+			return EAI_AGAIN;
+		}
+	}
+	return 0;
+}
+
+int getaddrinfo_a(int mode, struct gaicb *list[], int ent, struct sigevent *sig)
+{
+	struct batch *batch;
+	int ret = 0;
+	int i;
+
+	if (mode != GAI_WAIT && mode != GAI_NOWAIT) {
+		errno = EINVAL;
+		return EAI_SYSTEM;
+	}
+	batch = calloc(1, sizeof(*batch));
+	if (batch == NULL)
+		return EAI_MEMORY;
+	batch->nowait = mode == GAI_NOWAIT;
+	if (batch->nowait && sig != NULL)
+		batch->sig = *sig;
+	else
+		batch->sig.sigev_notify = SIGEV_NONE;
+
+	pthread_mutex_lock(&lock);
+	/* Hold one reference while queueing so the batch can't complete
+	   before every request is in.  */
+	batch->pending = 1;
+	for (i = 0; i < ent && ret == 0; i++)
+		if (list[i] != NULL)
+			ret = enqueue(list[i], batch);
+	batch->pending--;
+	if (batch->nowait) {
+		if (batch->pending == 0) {
+			if (ret == 0)
+				notify(&batch->sig);
+			free(batch);
+		}
+	} else {
+		while (batch->pending > 0)
+			pthread_cond_wait(&done_cond, &lock);
+		free(batch);
+	}
+	pthread_mutex_unlock(&lock);
+	return ret;
+}
+
+int gai_error(struct gaicb *req)
+{
+	int ret;
+
+	pthread_mutex_lock(&lock);
+	ret = req->__return;
+	pthread_mutex_unlock(&lock);
+	return ret;
+}
+
+int gai_cancel(struct gaicb *gaicbp)
+{
+	struct request **p;
+	int ret = EAI_ALLDONE;
+
+	pthread_mutex_lock(&lock);
+	if (gaicbp->__return == EAI_INPROGRESS) {
+		ret = EAI_NOTCANCELED;
+		for (p = &queue_head; *p != NULL; p = &(*p)->next) {
+			struct request *req = *p;
+
+			if (req->gaicb != gaicbp)
+				continue;
+			*p = req->next;
+			if (queue_tail == req)
+				for (queue_tail = queue_head; queue_tail != NULL && queue_tail->next != NULL;
+				     queue_tail = queue_tail->next)
+					;
+			finish(req, EAI_CANCELED);
+			ret = EAI_CANCELED;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&lock);
+	return ret;
+}
+
+int gai_suspend(const struct gaicb *const list[], int ent, const struct timespec *timeout)
+{
+	struct timespec deadline;
+	int ret = 0;
+	int i;
+
+	if (timeout != NULL) {
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += timeout->tv_sec;
+		deadline.tv_nsec += timeout->tv_nsec;
+		if (deadline.tv_nsec >= 1000000000) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000;
+		}
+	}
+
+	pthread_mutex_lock(&lock);
+	for (;;) {
+		int active = 0;
+
+		for (i = 0; i < ent; i++) {
+			if (list[i] == NULL)
+				continue;
+			if (list[i]->__return != EAI_INPROGRESS)
+				goto out;
+			active = 1;
+		}
+		if (!active) {
+			ret = EAI_ALLDONE;
+			break;
+		}
+		if (timeout == NULL) {
+			pthread_cond_wait(&done_cond, &lock);
+		} else if (pthread_cond_timedwait(&done_cond, &lock, &deadline) == ETIMEDOUT) {
+			ret = EAI_AGAIN;
+			break;
+		}
+	}
+out:
+	pthread_mutex_unlock(&lock);
+	return ret;
+}
@@ -0,0 +1,70 @@
+/* _dl_find_object for libgcc_eh.a on glibc 2.31.
+
+   The libgcc_eh.a shipped with the GCC 12 crt files looks up unwind tables
+   with _dl_find_object, which glibc only gained in 2.35.  This is the
+   dl_iterate_phdr based lookup libgcc used before that, folded into the
+   interface it now expects, so static and -static-libgcc links against the
+   root keep working.  It is hidden, so it never shadows a real
+   _dl_find_object from a newer libc.so at run time.  */
+
+#define _GNU_SOURCE
+#include <link.h>
+#include <stddef.h>
+
+struct dl_find_object {
+	unsigned long long int dlfo_flags;
+	void *dlfo_map_start;
+	void *dlfo_map_end;
+	struct link_map *dlfo_link_map;
+	void *dlfo_eh_frame;
+	unsigned long long int __dlfo_reserved[7];
+};
+
+struct find_object_data {
+	ElfW(Addr) pc;
+	struct dl_find_object *result;
+};
+
+static int find_object_callback(struct dl_phdr_info *info, size_t size, void *ptr)
+{
+	struct find_object_data *data = ptr;
+	const ElfW(Phdr) *eh_frame = NULL;
+	ElfW(Addr) start = ~(ElfW(Addr))0;
+	ElfW(Addr) end = 0;
+	int found = 0;
+	ElfW(Half) i;
+
+	(void)size;
+	for (i = 0; i < info->dlpi_phnum; i++) {
+		const ElfW(Phdr) *phdr = &info->dlpi_phdr[i];
+		if (phdr->p_type == PT_LOAD) {
+			ElfW(Addr) lo = info->dlpi_addr + phdr->p_vaddr;
+			ElfW(Addr) hi = lo + phdr->p_memsz;
+			if (lo < start)
+				start = lo;
+			if (hi > end)
+				end = hi;
+			if (data->pc >= lo && data->pc < hi)
+				found = 1;
+		} else if (phdr->p_type == PT_GNU_EH_FRAME) {
+			eh_frame = phdr;
+		}
+	}
+	if (!found)
+		return 0;
+
+	data->result->dlfo_flags = 0;
+	data->result->dlfo_map_start = (void *)start;
+	data->result->dlfo_map_end = (void *)end;
+	data->result->dlfo_link_map = NULL;
+	data->result->dlfo_eh_frame = eh_frame == NULL ? NULL
+		: (void *)(info->dlpi_addr + eh_frame->p_vaddr);
+	return 1;
+}
+
+__attribute__((visibility("hidden")))
+int _dl_find_object(void *pc, struct dl_find_object *result)
+{
+	struct find_object_data data = { (ElfW(Addr))pc, result };
+	return dl_iterate_phdr(find_object_callback, &data) ? 0 : -1;
+}
@@ -0,0 +1,787 @@
+/* librt for the root.
+
+   glibc 2.31 keeps shm_open, the POSIX timers, POSIX message queues and
+   POSIX AIO in librt, and no librt is shipped with the root.  This is a
+   small implementation of the same interface on top of libc and the raw
+   system calls, exporting the x86_64 librt.so.1 symbol versions, so that
+   programs link against the root exactly as they would against glibc and
+   pick up the target's real librt at run time.  It also makes them run
+   under the root's own ld.so.
+
+   SIGEV_THREAD notification runs the function on a new detached thread,
+   as libanl does, with fresh attributes that only take over the caller's
+   stack size.  Timers and message queues need a helper thread to learn
+   that the event happened, as in glibc: one waits for the timers' signal
+   (glibc's own SIGTIMER, which the application never sees), the other
+   reads the kernel's mq_notify cookies from a netlink socket.  Programs
+   linking librt.a statically link -lpthread too.
+
+   Left out on purpose: AIO requests complete synchronously, before
+   aio_read, aio_write, aio_fsync or lio_listio return (and notify, with
+   any SIGEV_THREAD on a thread of its own), so aio_suspend never waits
+   and aio_cancel always reports AIO_ALLDONE.  A child of fork has none of
+   its parent's SIGEV_THREAD timers, as POSIX says, and librt starts new
+   helpers in it the first time it needs them.  No pthread_atfork handler
+   resets the locks, so a process must not fork while another thread is
+   in timer_create, timer_delete or mq_notify.  */
+
+#define _GNU_SOURCE
+#include <aio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <mqueue.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef SHARED
+# define versioned_symbol(local, name, version) \
+	__asm__(".symver " #local "," #name "@@" #version)
+# define compat_symbol(local, name, version) \
+	__asm__(".symver " #local "," #name "@" #version)
+#else
+# define versioned_symbol(local, name, version) \
+	extern __typeof(local) name __attribute__((alias(#local)))
+#endif
+
+#define SHM_DIR "/dev/shm/"
+
+/* glibc 2.31's SIGTIMER, the same signal as its SIGCANCEL: sigprocmask
+   and sigaction refuse it, so only the timer helper ever receives it.  */
+#define SIGTIMER 32
+
+/* From linux/mqueue.h, whose struct mq_attr clashes with mqueue.h's.  */
+#define NOTIFY_WOKENUP 1
+#define NOTIFY_COOKIE_LEN 32
+
+static int check_sigevent(const struct sigevent *sev)
+{
+	if (sev == NULL || sev->sigev_notify == SIGEV_NONE
+	    || sev->sigev_notify == SIGEV_SIGNAL
+	    || sev->sigev_notify == SIGEV_THREAD
+	    || sev->sigev_notify == SIGEV_THREAD_ID)
+		return 0;
+	errno = EINVAL;
+	return -1;
+}
+
+/* SIGEV_THREAD.  */
+
+static void *notify_thread(void *arg)
+{
+	struct sigevent *sev = arg;
+
+	sev->sigev_notify_function(sev->sigev_value);
+	free(sev);
+	return NULL;
+}
+
+static void notify_thread_start(const struct sigevent *sev)
+{
+	struct sigevent *copy = malloc(sizeof(*copy));
+	pthread_attr_t attr;
+	pthread_t thread;
+	size_t stacksize;
+
+	if (copy == NULL)
+		return;
+	*copy = *sev;
+	/* pthread_attr_t is opaque and may own memory, so it is not copied:
+	   only the caller's stack size is taken over.  */
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	if (sev->sigev_notify_attributes != NULL
+	    && pthread_attr_getstacksize(sev->sigev_notify_attributes, &stacksize) == 0)
+		pthread_attr_setstacksize(&attr, stacksize);
+	if (pthread_create(&thread, &attr, notify_thread, copy) != 0)
+		free(copy);
+	pthread_attr_destroy(&attr);
+}
+
+/* Starts a detached helper thread with every signal blocked, so that it
+   takes none of the application's.  */
+static int helper_start(void *(*fn)(void *), void *arg)
+{
+	pthread_attr_t attr;
+	pthread_t thread;
+	sigset_t all, old;
+	int err;
+
+	sigfillset(&all);
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	pthread_sigmask(SIG_BLOCK, &all, &old);
+	err = pthread_create(&thread, &attr, fn, arg);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	pthread_attr_destroy(&attr);
+	if (err != 0) {
+		errno = err;
+		return -1;
+	}
+	return 0;
+}
+
+/* Shared memory.  */
+
+static int shm_path(char *path, const char *name)
+{
+	size_t len;
+
+	while (*name == '/')
+		name++;
+	len = strlen(name);
+	if (len == 0 || len >= NAME_MAX || strchr(name, '/') != NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	memcpy(path, SHM_DIR, sizeof(SHM_DIR) - 1);
+	memcpy(path + sizeof(SHM_DIR) - 1, name, len + 1);
+	return 0;
+}
+
+int shm_open(const char *name, int oflag, mode_t mode)
+{
+	char path[sizeof(SHM_DIR) + NAME_MAX];
+
+	if (shm_path(path, name) < 0)
+		return -1;
+	return open(path, oflag | O_NOFOLLOW | O_CLOEXEC, mode);
+}
+
+int shm_unlink(const char *name)
+{
+	char path[sizeof(SHM_DIR) + NAME_MAX];
+	int ret;
+
+	if (shm_path(path, name) < 0)
+		return -1;
+	ret = unlink(path);
+	if (ret < 0 && errno == EPERM)
+		errno = EACCES;
+	return ret;
+}
+
+/* POSIX timers.  timer_t carries the kernel timer id.  A SIGEV_THREAD
+   timer is a kernel timer that sends SIGTIMER to the helper thread, with
+   its entry in thread_timers as the value.  */
+
+struct thread_timer {
+	int ktimerid;
+	struct sigevent sev;
+	struct thread_timer *next;
+};
+
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timer_cond = PTHREAD_COND_INITIALIZER;
+static struct thread_timer *thread_timers;
+/* The process the helper runs in, and its thread id.  */
+static pid_t timer_helper_pid, timer_helper_tid;
+
+static void *timer_helper(void *arg)
+{
+	/* A kernel sigset_t: glibc's sigaddset refuses SIGTIMER.  */
+	unsigned long set = 1UL << (SIGTIMER - 1);
+	struct thread_timer *t;
+	struct sigevent sev;
+	siginfo_t info;
+
+	(void)arg;
+	syscall(SYS_rt_sigprocmask, SIG_BLOCK, &set, NULL, sizeof(set));
+	pthread_mutex_lock(&timer_lock);
+	timer_helper_tid = syscall(SYS_gettid);
+	pthread_cond_broadcast(&timer_cond);
+	pthread_mutex_unlock(&timer_lock);
+	for (;;) {
+		if (syscall(SYS_rt_sigtimedwait, &set, &info, NULL, sizeof(set)) < 0
+		    || info.si_code != SI_TIMER)
+			continue;
+		/* The timer may have been deleted since the signal was sent.  */
+		pthread_mutex_lock(&timer_lock);
+		for (t = thread_timers; t != NULL; t = t->next)
+			if (t == info.si_value.sival_ptr && t->ktimerid == info.si_timerid)
+				break;
+		if (t != NULL)
+			sev = t->sev;
+		pthread_mutex_unlock(&timer_lock);
+		if (t != NULL)
+			notify_thread_start(&sev);
+	}
+	return NULL;
+}
+
+/* Called with timer_lock held.  */
+static int timer_helper_start(void)
+{
+	pid_t pid = getpid();
+
+	if (timer_helper_pid == pid)
+		return 0;
+	/* A child of fork has neither the parent's timers nor its helper.  */
+	while (thread_timers != NULL) {
+		struct thread_timer *t = thread_timers;
+
+		thread_timers = t->next;
+		free(t);
+	}
+	timer_helper_tid = 0;
+	if (helper_start(timer_helper, NULL) < 0)
+		return -1;
+	while (timer_helper_tid == 0)
+		pthread_cond_wait(&timer_cond, &timer_lock);
+	timer_helper_pid = pid;
+	return 0;
+}
+
+static int timer_create_thread(clockid_t clock_id, const struct sigevent *evp, int *ktimerid)
+{
+	struct thread_timer *t = malloc(sizeof(*t));
+	struct sigevent kev;
+	int ret;
+
+	if (t == NULL)
+		return -1;
+	t->sev = *evp;
+	memset(&kev, 0, sizeof(kev));
+	kev.sigev_notify = SIGEV_THREAD_ID;
+	kev.sigev_signo = SIGTIMER;
+	kev.sigev_value.sival_ptr = t;
+	pthread_mutex_lock(&timer_lock);
+	ret = timer_helper_start();
+	if (ret == 0) {
+		kev._sigev_un._tid = timer_helper_tid;
+		ret = syscall(SYS_timer_create, clock_id, &kev, &t->ktimerid);
+	}
+	if (ret == 0) {
+		t->next = thread_timers;
+		thread_timers = t;
+		*ktimerid = t->ktimerid;
+	}
+	pthread_mutex_unlock(&timer_lock);
+	if (ret < 0)
+		free(t);
+	return ret;
+}
+
+static int timer_create_kernel(clockid_t clock_id, struct sigevent *evp, int *ktimerid)
+{
+	if (check_sigevent(evp) < 0)
+		return -1;
+	if (evp != NULL && evp->sigev_notify == SIGEV_THREAD)
+		return timer_create_thread(clock_id, evp, ktimerid);
+	return syscall(SYS_timer_create, clock_id, evp, ktimerid);
+}
+
+static int timer_delete_kernel(int ktimerid)
+{
+	struct thread_timer **p, *t;
+
+	if (syscall(SYS_timer_delete, ktimerid) < 0)
+		return -1;
+	pthread_mutex_lock(&timer_lock);
+	for (p = &thread_timers; (t = *p) != NULL; p = &t->next)
+		if (t->ktimerid == ktimerid) {
+			*p = t->next;
+			free(t);
+			break;
+		}
+	pthread_mutex_unlock(&timer_lock);
+	return 0;
+}
+
+int __rt_timer_create(clockid_t clock_id, struct sigevent *evp, timer_t *timerid)
+{
+	int ktimerid;
+
+	if (timer_create_kernel(clock_id, evp, &ktimerid) < 0)
+		return -1;
+	*timerid = (timer_t)(intptr_t)ktimerid;
+	return 0;
+}
+versioned_symbol(__rt_timer_create, timer_create, GLIBC_2.3.3);
+
+int __rt_timer_delete(timer_t timerid)
+{
+	return timer_delete_kernel((int)(intptr_t)timerid);
+}
+versioned_symbol(__rt_timer_delete, timer_delete, GLIBC_2.3.3);
+
+int __rt_timer_getoverrun(timer_t timerid)
+{
+	return syscall(SYS_timer_getoverrun, (int)(intptr_t)timerid);
+}
+versioned_symbol(__rt_timer_getoverrun, timer_getoverrun, GLIBC_2.3.3);
+
+int __rt_timer_gettime(timer_t timerid, struct itimerspec *value)
+{
+	return syscall(SYS_timer_gettime, (int)(intptr_t)timerid, value);
+}
+versioned_symbol(__rt_timer_gettime, timer_gettime, GLIBC_2.3.3);
+
+int __rt_timer_settime(timer_t timerid, int flags, const struct itimerspec *value,
+		     struct itimerspec *ovalue)
+{
+	return syscall(SYS_timer_settime, (int)(intptr_t)timerid, flags, value, ovalue);
+}
+versioned_symbol(__rt_timer_settime, timer_settime, GLIBC_2.3.3);
+
+#ifdef SHARED
+/* The GLIBC_2.2.5 timers predate timer_t being a pointer and hand out the
+   id as an int.  */
+
+int __rt_timer_create_old(clockid_t clock_id, struct sigevent *evp, int *timerid)
+{
+	return timer_create_kernel(clock_id, evp, timerid);
+}
+compat_symbol(__rt_timer_create_old, timer_create, GLIBC_2.2.5);
+
+int __rt_timer_delete_old(int timerid)
+{
+	return timer_delete_kernel(timerid);
+}
+compat_symbol(__rt_timer_delete_old, timer_delete, GLIBC_2.2.5);
+
+int __rt_timer_getoverrun_old(int timerid)
+{
+	return syscall(SYS_timer_getoverrun, timerid);
+}
+compat_symbol(__rt_timer_getoverrun_old, timer_getoverrun, GLIBC_2.2.5);
+
+int __rt_timer_gettime_old(int timerid, struct itimerspec *value)
+{
+	return syscall(SYS_timer_gettime, timerid, value);
+}
+compat_symbol(__rt_timer_gettime_old, timer_gettime, GLIBC_2.2.5);
+
+int __rt_timer_settime_old(int timerid, int flags, const struct itimerspec *value,
+			 struct itimerspec *ovalue)
+{
+	return syscall(SYS_timer_settime, timerid, flags, value, ovalue);
+}
+compat_symbol(__rt_timer_settime_old, timer_settime, GLIBC_2.2.5);
+
+/* The clock functions moved to libc in 2.17; librt keeps the old versions
+   for binaries linked before that.  */
+
+int __rt_clock_getcpuclockid(pid_t pid, clockid_t *clock_id)
+{
+	return clock_getcpuclockid(pid, clock_id);
+}
+compat_symbol(__rt_clock_getcpuclockid, clock_getcpuclockid, GLIBC_2.2.5);
+
+int __rt_clock_getres(clockid_t clock_id, struct timespec *res)
+{
+	return clock_getres(clock_id, res);
+}
+compat_symbol(__rt_clock_getres, clock_getres, GLIBC_2.2.5);
+
+int __rt_clock_gettime(clockid_t clock_id, struct timespec *tp)
+{
+	return clock_gettime(clock_id, tp);
+}
+compat_symbol(__rt_clock_gettime, clock_gettime, GLIBC_2.2.5);
+
+int __rt_clock_nanosleep(clockid_t clock_id, int flags, const struct timespec *req,
+		       struct timespec *rem)
+{
+	return clock_nanosleep(clock_id, flags, req, rem);
+}
+compat_symbol(__rt_clock_nanosleep, clock_nanosleep, GLIBC_2.2.5);
+
+int __rt_clock_settime(clockid_t clock_id, const struct timespec *tp)
+{
+	return clock_settime(clock_id, tp);
+}
+compat_symbol(__rt_clock_settime, clock_settime, GLIBC_2.2.5);
+#endif
+
+/* Message queues.  The kernel takes the name without the leading slash.
+   For SIGEV_THREAD it sends a cookie to a netlink socket instead of a
+   signal, once the notification fires or is removed; the helper reads
+   them.  Our cookies hold a copy of the caller's sigevent.  */
+
+static pthread_mutex_t mq_lock = PTHREAD_MUTEX_INITIALIZER;
+static int mq_sock = -1;
+static pid_t mq_helper_pid;
+
+static void *mq_helper(void *arg)
+{
+	int sock = (int)(intptr_t)arg;
+	unsigned char cookie[NOTIFY_COOKIE_LEN];
+	struct sigevent *sev;
+	ssize_t n;
+
+	for (;;) {
+		n = recv(sock, cookie, sizeof(cookie), MSG_WAITALL | MSG_NOSIGNAL);
+		if (n < 0 && errno != EINTR)
+			return NULL;
+		if (n != sizeof(cookie))
+			continue;
+		memcpy(&sev, cookie, sizeof(sev));
+		if (cookie[NOTIFY_COOKIE_LEN - 1] == NOTIFY_WOKENUP)
+			notify_thread_start(sev);
+		free(sev);
+	}
+}
+
+/* Called with mq_lock held.  */
+static int mq_helper_start(void)
+{
+	pid_t pid = getpid();
+
+	if (mq_helper_pid == pid)
+		return 0;
+	/* After fork, the parent's socket has no reader in the child.  */
+	if (mq_sock >= 0)
+		close(mq_sock);
+	mq_sock = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, 0);
+	if (mq_sock < 0)
+		return -1;
+	if (helper_start(mq_helper, (void *)(intptr_t)mq_sock) < 0) {
+		close(mq_sock);
+		mq_sock = -1;
+		return -1;
+	}
+	mq_helper_pid = pid;
+	return 0;
+}
+
+static int mq_notify_thread(mqd_t mqdes, const struct sigevent *notification)
+{
+	unsigned char cookie[NOTIFY_COOKIE_LEN];
+	struct sigevent kev, *copy = malloc(sizeof(*copy));
+	int ret;
+
+	if (copy == NULL)
+		return -1;
+	*copy = *notification;
+	memset(cookie, 0, sizeof(cookie));
+	memcpy(cookie, &copy, sizeof(copy));
+	memset(&kev, 0, sizeof(kev));
+	kev.sigev_notify = SIGEV_THREAD;
+	kev.sigev_value.sival_ptr = cookie;
+	pthread_mutex_lock(&mq_lock);
+	ret = mq_helper_start();
+	if (ret == 0) {
+		kev.sigev_signo = mq_sock;
+		ret = syscall(SYS_mq_notify, mqdes, &kev);
+	}
+	pthread_mutex_unlock(&mq_lock);
+	if (ret < 0)
+		free(copy);
+	return ret;
+}
+
+mqd_t mq_open(const char *name, int oflag, ...)
+{
+	mode_t mode = 0;
+	struct mq_attr *attr = NULL;
+
+	if (name[0] != '/') {
+		errno = EINVAL;
+		return -1;
+	}
+	if (oflag & O_CREAT) {
+		va_list ap;
+
+		va_start(ap, oflag);
+		mode = va_arg(ap, mode_t);
+		attr = va_arg(ap, struct mq_attr *);
+		va_end(ap);
+	}
+	return syscall(SYS_mq_open, name + 1, oflag, mode, attr);
+}
+
+mqd_t __mq_open_2(const char *name, int oflag)
+{
+	if (oflag & O_CREAT)
+		abort();
+	return mq_open(name, oflag);
+}
+
+int mq_close(mqd_t mqdes)
+{
+	return close(mqdes);
+}
+
+int mq_unlink(const char *name)
+{
+	int ret;
+
+	if (name[0] != '/') {
+		errno = EINVAL;
+		return -1;
+	}
+	ret = syscall(SYS_mq_unlink, name + 1);
+	if (ret < 0 && errno == EPERM)
+		errno = EACCES;
+	return ret;
+}
+
+int mq_getattr(mqd_t mqdes, struct mq_attr *mqstat)
+{
+	return syscall(SYS_mq_getsetattr, mqdes, NULL, mqstat);
+}
+
+int mq_setattr(mqd_t mqdes, const struct mq_attr *mqstat, struct mq_attr *omqstat)
+{
+	return syscall(SYS_mq_getsetattr, mqdes, mqstat, omqstat);
+}
+
+int mq_notify(mqd_t mqdes, const struct sigevent *notification)
+{
+	if (check_sigevent(notification) < 0)
+		return -1;
+	if (notification != NULL && notification->sigev_notify == SIGEV_THREAD)
+		return mq_notify_thread(mqdes, notification);
+	return syscall(SYS_mq_notify, mqdes, notification);
+}
+
+ssize_t mq_timedreceive(mqd_t mqdes, char *msg_ptr, size_t msg_len,
+			unsigned int *msg_prio, const struct timespec *abs_timeout)
+{
+	return syscall(SYS_mq_timedreceive, mqdes, msg_ptr, msg_len, msg_prio, abs_timeout);
+}
+
+int mq_timedsend(mqd_t mqdes, const char *msg_ptr, size_t msg_len,
+		 unsigned int msg_prio, const struct timespec *abs_timeout)
+{
+	return syscall(SYS_mq_timedsend, mqdes, msg_ptr, msg_len, msg_prio, abs_timeout);
+}
+
+/* mq_timedreceive and mq_timedsend are declared with a non-null timeout.  */
+
+ssize_t mq_receive(mqd_t mqdes, char *msg_ptr, size_t msg_len, unsigned int *msg_prio)
+{
+	return syscall(SYS_mq_timedreceive, mqdes, msg_ptr, msg_len, msg_prio, NULL);
+}
+
+int mq_send(mqd_t mqdes, const char *msg_ptr, size_t msg_len, unsigned int msg_prio)
+{
+	return syscall(SYS_mq_timedsend, mqdes, msg_ptr, msg_len, msg_prio, NULL);
+}
+
+/* Asynchronous I/O.  struct aiocb and struct aiocb64 are the same on
+   x86_64, so the 64-bit entry points share the implementation.  */
+
+static void aio_notify(const struct sigevent *sev)
+{
+	siginfo_t info;
+
+	if (sev->sigev_notify == SIGEV_THREAD)
+		notify_thread_start(sev);
+	if (sev->sigev_notify != SIGEV_SIGNAL)
+		return;
+	memset(&info, 0, sizeof(info));
+	info.si_signo = sev->sigev_signo;
+	info.si_code = SI_ASYNCIO;
+	info.si_pid = getpid();
+	info.si_uid = getuid();
+	info.si_value = sev->sigev_value;
+	syscall(SYS_rt_sigqueueinfo, info.si_pid, info.si_signo, &info);
+}
+
+static void aio_complete(struct aiocb *cb, ssize_t ret)
+{
+	cb->__return_value = ret;
+	cb->__error_code = ret < 0 ? errno : 0;
+}
+
+static void aio_perform(struct aiocb *cb)
+{
+	void *buf = (void *)cb->aio_buf;
+	int flags;
+
+	switch (cb->aio_lio_opcode) {
+	case LIO_READ:
+		aio_complete(cb, pread(cb->aio_fildes, buf, cb->aio_nbytes, cb->aio_offset));
+		break;
+	case LIO_WRITE:
+		/* pwrite ignores the offset on O_APPEND descriptors anyway;
+		   write says so.  */
+		flags = fcntl(cb->aio_fildes, F_GETFL);
+		if (flags >= 0 && (flags & O_APPEND))
+			aio_complete(cb, write(cb->aio_fildes, buf, cb->aio_nbytes));
+		else
+			aio_complete(cb, pwrite(cb->aio_fildes, buf, cb->aio_nbytes, cb->aio_offset));
+		break;
+	case O_SYNC:
+		aio_complete(cb, fsync(cb->aio_fildes));
+		break;
+	case O_DSYNC:
+		aio_complete(cb, fdatasync(cb->aio_fildes));
+		break;
+	default:
+		cb->__return_value = 0;
+		cb->__error_code = 0;
+		break;
+	}
+}
+
+static int aio_submit(struct aiocb *cb, int opcode)
+{
+	if (check_sigevent(&cb->aio_sigevent) < 0)
+		return -1;
+	cb->aio_lio_opcode = opcode;
+	aio_perform(cb);
+	aio_notify(&cb->aio_sigevent);
+	return 0;
+}
+
+void aio_init(const struct aioinit *init)
+{
+	(void)init;
+}
+
+int aio_read(struct aiocb *aiocbp)
+{
+	return aio_submit(aiocbp, LIO_READ);
+}
+
+int aio_write(struct aiocb *aiocbp)
+{
+	return aio_submit(aiocbp, LIO_WRITE);
+}
+
+int aio_fsync(int op, struct aiocb *aiocbp)
+{
+	if (op != O_SYNC && op != O_DSYNC) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (fcntl(aiocbp->aio_fildes, F_GETFL) < 0) {
+		errno = EBADF;
+		return -1;
+	}
+	return aio_submit(aiocbp, op);
+}
+
+int aio_error(const struct aiocb *aiocbp)
+{
+	return aiocbp->__error_code;
+}
+
+ssize_t aio_return(struct aiocb *aiocbp)
+{
+	return aiocbp->__return_value;
+}
+
+int aio_cancel(int fildes, struct aiocb *aiocbp)
+{
+	if (aiocbp != NULL && aiocbp->aio_fildes != fildes) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (fcntl(fildes, F_GETFL) < 0) {
+		errno = EBADF;
+		return -1;
+	}
+	return AIO_ALLDONE;
+}
+
+int aio_suspend(const struct aiocb *const list[], int nent,
+		const struct timespec *timeout)
+{
+	int i;
+
+	(void)timeout;
+	for (i = 0; i < nent; i++)
+		if (list[i] != NULL)
+			return 0;
+	errno = EAGAIN;
+	return -1;
+}
+
+int __rt_lio_listio(int mode, struct aiocb *const list[], int nent, struct sigevent *sig)
+{
+	int failed = 0;
+	int i;
+
+	if ((mode != LIO_WAIT && mode != LIO_NOWAIT) || nent < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (mode == LIO_NOWAIT && check_sigevent(sig) < 0)
+		return -1;
+	for (i = 0; i < nent; i++) {
+		if (list[i] == NULL || list[i]->aio_lio_opcode == LIO_NOP)
+			continue;
+		if (mode == LIO_NOWAIT && check_sigevent(&list[i]->aio_sigevent) < 0)
+			return -1;
+	}
+	for (i = 0; i < nent; i++) {
+		if (list[i] == NULL || list[i]->aio_lio_opcode == LIO_NOP)
+			continue;
+		aio_perform(list[i]);
+		failed |= list[i]->__error_code != 0;
+		if (mode == LIO_NOWAIT)
+			aio_notify(&list[i]->aio_sigevent);
+	}
+	if (mode == LIO_NOWAIT) {
+		if (sig != NULL)
+			aio_notify(sig);
+		return 0;
+	}
+	if (failed) {
+		errno = EIO;
+		return -1;
+	}
+	return 0;
+}
+versioned_symbol(__rt_lio_listio, lio_listio, GLIBC_2.4);
+#ifdef SHARED
+compat_symbol(__rt_lio_listio, lio_listio, GLIBC_2.2.5);
+#endif
+
+int aio_read64(struct aiocb64 *aiocbp)
+{
+	return aio_read((struct aiocb *)aiocbp);
+}
+
+int aio_write64(struct aiocb64 *aiocbp)
+{
+	return aio_write((struct aiocb *)aiocbp);
+}
+
+int aio_fsync64(int op, struct aiocb64 *aiocbp)
+{
+	return aio_fsync(op, (struct aiocb *)aiocbp);
+}
+
+int aio_error64(const struct aiocb64 *aiocbp)
+{
+	return aio_error((const struct aiocb *)aiocbp);
+}
+
+ssize_t aio_return64(struct aiocb64 *aiocbp)
+{
+	return aio_return((struct aiocb *)aiocbp);
+}
+
+int aio_cancel64(int fildes, struct aiocb64 *aiocbp)
+{
+	return aio_cancel(fildes, (struct aiocb *)aiocbp);
+}
+
+int aio_suspend64(const struct aiocb64 *const list[], int nent,
+		  const struct timespec *timeout)
+{
+	return aio_suspend((const struct aiocb *const *)list, nent, timeout);
+}
+
+int __rt_lio_listio64(int mode, struct aiocb64 *const list[], int nent, struct sigevent *sig)
+{
+	return __rt_lio_listio(mode, (struct aiocb *const *)list, nent, sig);
+}
+versioned_symbol(__rt_lio_listio64, lio_listio64, GLIBC_2.4);
+#ifdef SHARED
+compat_symbol(__rt_lio_listio64, lio_listio64, GLIBC_2.2.5);
+#endif
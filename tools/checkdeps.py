@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+"""Checks that every shared object in the root can be loaded and linked.
+
+For each ELF shared object in lib/ and usr/lib/ it reports
+
+  - DT_NEEDED entries that no file in the library directories provides;
+  - symbol versions it needs (e.g. GLIBC_2.34 from libc.so.6) that the
+    providing library doesn't define, which ld.so refuses at start-up;
+  - undefined, non-weak symbols that nothing in its DT_NEEDED closure
+    defines, which fail a link with --no-allow-shlib-undefined (the
+    default for executables with GNU ld and lld):
+
+    tools/checkdeps.py
+    tools/checkdeps.py lib/x86_64-linux-gnu/libzmq.so.5
+
+It exits with status 1 if anything is unresolved. Run it after adding a
+library, and before shipping one taken from a newer distribution.
+"""
+
+import argparse
+import collections
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from slim import LIBDIRS, find_soname, full  # noqa: E402
+
+SHT_DYNAMIC, SHT_DYNSYM = 6, 11
+SHT_GNU_VERDEF, SHT_GNU_VERNEED, SHT_GNU_VERSYM = 0x6ffffffd, 0x6ffffffe, 0x6fffffff
+DT_NEEDED, DT_SONAME = 1, 14
+SHN_UNDEF = 0
+STB_WEAK = 2
+VER_FLG_BASE = 1
+VERSYM_HIDDEN = 0x8000
+
+# Symbols a library leaves for its user to define, by design.
+EXPECTED_UNDEFINED = {
+	# proc_service: provided by the debugger that loads libthread_db.
+	'libthread_db.so.1': {'ps_getpid', 'ps_pdread', 'ps_pdwrite', 'ps_pglobal_lookup',
+		'ps_lgetregs', 'ps_lsetregs', 'ps_lgetfpregs', 'ps_lsetfpregs'},
+	# Taken from libunwind-generic or libunwind-x86_64, which the program
+	# links next to them, and (for ptrace) liblzma for MiniDebugInfo.
+	'libunwind-coredump.so.0': {'_Ux86_64_get_elf_image', '_Ux86_64_dwarf_find_unwind_table',
+		'_Ux86_64_dwarf_search_unwind_table'},
+	'libunwind-ptrace.so.0': {'_Ux86_64_get_elf_image', '_Ux86_64_dwarf_find_unwind_table',
+		'_Ux86_64_dwarf_search_unwind_table', 'lzma_stream_buffer_decode',
+		'lzma_stream_footer_decode', 'lzma_index_buffer_decode', 'lzma_index_uncompressed_size',
+		'lzma_index_size', 'lzma_index_end'},
+}
+
+ElfLibrary = collections.namedtuple('ElfLibrary', 'soname needed defined undefined verneed verdef')
+
+
+def read_elf(path):
+	"""Parses the dynamic symbol table and version sections of an ELF shared object.
+
+	Returns None for anything else. defined maps each exported name to the
+	set of versions it is defined at (None for unversioned), undefined lists
+	(name, version, weak), verneed maps each file to the versions needed
+	from it and verdef is the set of versions the object defines.
+	"""
+	with open(path, 'rb') as f:
+		data = f.read()
+	if data[:4] != b'\x7fELF' or data[5] != 1:
+		return None
+	if data[4] == 2:
+		shoff, = struct.unpack_from('<Q', data, 0x28)
+		shentsize, shnum = struct.unpack_from('<HH', data, 0x3a)
+		shdr, dyn, sym = '<IIQQQQIIQQ', '<qQ', '<IBBHQQ'
+		sym_fields = lambda s: (s[0], s[1], s[3])
+	else:
+		shoff, = struct.unpack_from('<I', data, 0x20)
+		shentsize, shnum = struct.unpack_from('<HH', data, 0x2e)
+		shdr, dyn, sym = '<IIIIIIIIII', '<iI', '<IIIBBH'
+		sym_fields = lambda s: (s[0], s[3], s[5])
+	sections = [struct.unpack_from(shdr, data, shoff + i * shentsize) for i in range(shnum)]
+	by_type = {sh[1]: sh for sh in sections}
+	if SHT_DYNAMIC not in by_type:
+		return None
+
+	def strings(sh):
+		base = sections[sh[6]][4]
+		return lambda o: data[base + o:data.index(b'\0', base + o)].decode(errors='replace')
+
+	soname, needed = None, []
+	dynamic = by_type[SHT_DYNAMIC]
+	string = strings(dynamic)
+	for off in range(dynamic[4], dynamic[4] + dynamic[5], struct.calcsize(dyn)):
+		tag, val = struct.unpack_from(dyn, data, off)
+		if tag == DT_NEEDED:
+			needed.append(string(val))
+		elif tag == DT_SONAME:
+			soname = string(val)
+
+	# Version indexes, as used by .gnu.version, to names.
+	versions, verneed, verdef = {}, collections.defaultdict(set), set()
+	if SHT_GNU_VERDEF in by_type:
+		sh = by_type[SHT_GNU_VERDEF]
+		string = strings(sh)
+		off = sh[4]
+		while True:
+			_, flags, ndx, cnt, _, aux, nxt = struct.unpack_from('<HHHHIII', data, off)
+			name, = struct.unpack_from('<I', data, off + aux)
+			if not flags & VER_FLG_BASE:
+				versions[ndx] = string(name)
+				verdef.add(string(name))
+			if not nxt:
+				break
+			off += nxt
+	if SHT_GNU_VERNEED in by_type:
+		sh = by_type[SHT_GNU_VERNEED]
+		string = strings(sh)
+		off = sh[4]
+		while True:
+			_, cnt, file, aux, nxt = struct.unpack_from('<HHIII', data, off)
+			a = off + aux
+			for _ in range(cnt):
+				_, _, other, name, anxt = struct.unpack_from('<IHHII', data, a)
+				versions[other] = string(name)
+				verneed[string(file)].add(string(name))
+				a += anxt
+			if not nxt:
+				break
+			off += nxt
+
+	defined, undefined = collections.defaultdict(set), []
+	dynsym = by_type.get(SHT_DYNSYM)
+	if dynsym:
+		string = strings(dynsym)
+		versym = by_type.get(SHT_GNU_VERSYM)
+		entsize = struct.calcsize(sym)
+		for i in range(1, dynsym[5] // entsize):
+			name, info, shndx = sym_fields(struct.unpack_from(sym, data, dynsym[4] + i * entsize))
+			name = string(name)
+			version = None
+			if versym:
+				ndx, = struct.unpack_from('<H', data, versym[4] + 2 * i)
+				version = versions.get(ndx & ~VERSYM_HIDDEN)
+			if shndx == SHN_UNDEF:
+				undefined.append((name, version, info >> 4 == STB_WEAK))
+			else:
+				defined[name].add(version)
+	return ElfLibrary(soname, needed, defined, undefined, verneed, verdef)
+
+
+class Root:
+	def __init__(self):
+		self.cache = {}
+
+	def load(self, soname):
+		"""Returns (path, ElfLibrary) for a soname, or None if the root lacks it."""
+		if soname not in self.cache:
+			path = find_soname(soname)
+			lib = read_elf(full(path)) if path else None
+			self.cache[soname] = (path, lib) if lib else None
+		return self.cache[soname]
+
+	def closure(self, lib):
+		"""Returns the libraries in the DT_NEEDED closure of lib, breadth first."""
+		seen, order, todo = set(), [], list(lib.needed)
+		while todo:
+			soname = todo.pop(0)
+			if soname in seen:
+				continue
+			seen.add(soname)
+			loaded = self.load(soname)
+			if loaded:
+				order.append(loaded[1])
+				todo += loaded[1].needed
+		return order
+
+
+def check(root, relpath):
+	"""Returns the problems found in one shared object, as strings."""
+	lib = read_elf(full(relpath))
+	if lib is None:
+		return []
+	problems, bad_versions = [], set()
+	for soname in lib.needed:
+		if root.load(soname) is None:
+			problems.append('needs %s, which the root lacks' % soname)
+	for soname, versions in sorted(lib.verneed.items()):
+		loaded = root.load(soname)
+		if loaded is None:
+			continue
+		for v in sorted(versions - loaded[1].verdef):
+			problems.append('needs %s from %s, which it does not define' % (v, soname))
+			bad_versions.add(v)
+	if any(root.load(s) is None for s in lib.needed):
+		# Symbols from a missing library would all be reported again.
+		return problems
+	providers = [lib] + root.closure(lib)
+	expected = EXPECTED_UNDEFINED.get(lib.soname, ())
+	for name, version, weak in lib.undefined:
+		if weak or version in bad_versions or name in expected:
+			continue
+		if not any(name in p.defined and (version is None or version in p.defined[name])
+				for p in providers):
+			problems.append('undefined symbol %s%s' % (name, '@' + version if version else ''))
+	return problems
+
+
+def shared_objects():
+	for d in LIBDIRS:
+		for name in sorted(os.listdir(full(d))):
+			if '.so' in name and os.path.isfile(full(d + '/' + name)):
+				yield d + '/' + name
+
+
+def main():
+	parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+	parser.add_argument('files', nargs='*', help='shared objects to check (default: all of them)')
+	args = parser.parse_args()
+
+	root = Root()
+	failed = 0
+	for relpath in args.files or shared_objects():
+		problems = check(root, relpath)
+		for p in problems:
+			print('%s: %s' % (relpath, p))
+		failed += bool(problems)
+	if failed:
+		print('%d shared objects with unresolved dependencies' % failed, file=sys.stderr)
+	return 1 if failed else 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""Removes byte-identical copies from lib/ and usr/lib/.
+
+Debian installs one real file per library plus symlinks; the root has a
+full copy under every name, in both library directories. Symlinks don't
+survive a git checkout on Windows, so for each set of identical shared
+objects or archives this keeps one real file under every name something
+can ask for at link time, and drops the rest:
+
+  - the DT_SONAME, any name another library lists in DT_NEEDED and any
+    name a linker script refers to stay real files (once, preferring
+    lib/ for shared objects and usr/lib/ for archives);
+  - the name -lNAME resolves to (usr/lib/ first, as with the root's -L
+    order) becomes a one-line linker script, INPUT(libNAME.so.N), like
+    Debian's libcurses.so;
+  - other copies, such as libfoo.so.1.2.3 or the same file under the
+    other directory, are deleted.
+
+    tools/dedup.py --dry-run
+    tools/dedup.py
+
+It is idempotent; run it again after adding libraries.
+"""
+
+import argparse
+import collections
+import hashlib
+import os
+import re
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from slim import LIBDIRS, full, read_elf_dynamic, read_ld_script  # noqa: E402
+
+USR, LIB = LIBDIRS
+SCRIPT = 'INPUT(%s)\n'
+# glibc's real file names, such as libm-2.31.so; nothing links them by name.
+GLIBC_REAL_NAME = re.compile(r'-2\.31\.so$')
+
+
+def is_archive(path):
+	with open(path, 'rb') as f:
+		return f.read(8) == b'!<arch>\n'
+
+
+def is_dev_name(name):
+	return name.startswith('lib') and (name.endswith('.so') or name.endswith('.a')) \
+		and not GLIBC_REAL_NAME.search(name)
+
+
+def scan():
+	"""Returns (groups of identical files, names and paths that must stay real files)."""
+	by_hash = collections.defaultdict(list)
+	required = set()
+	for d in LIBDIRS:
+		for name in sorted(os.listdir(full(d))):
+			relpath = d + '/' + name
+			path = full(relpath)
+			if not os.path.isfile(path):
+				continue
+			inputs = read_ld_script(path)
+			if inputs is not None:
+				for i in inputs:
+					if not i.startswith('-l'):
+						required.update([os.path.basename(i), i.lstrip('/')])
+				continue
+			dynamic = read_elf_dynamic(path)
+			if dynamic is not None and '.so' in name:
+				soname, needed = dynamic
+				required.update(needed)
+				if soname:
+					required.add(soname)
+			elif not is_archive(path):
+				# Start files such as Scrt1.o and rcrt1.o are identical
+				# but picked by name by the compiler driver.
+				continue
+			with open(path, 'rb') as f:
+				by_hash[hashlib.sha1(f.read()).hexdigest()].append(relpath)
+	return [g for g in by_hash.values() if len(g) > 1], required
+
+
+def plan(group, required):
+	"""Returns ({path: None to delete or a script target}, size saved)."""
+	archive = group[0].endswith('.a')
+	prefer = [USR, LIB] if archive else [LIB, USR]
+	names = sorted({os.path.basename(p) for p in group})
+	keep = {p for p in group if p in required}
+	for name in names:
+		if name not in required:
+			continue
+		for d in prefer:
+			if d + '/' + name in group:
+				keep.add(d + '/' + name)
+				break
+	if not keep:
+		# Nothing asks for a particular name: keep the first name that -l
+		# finds, as a real file.
+		for name in names:
+			for d in LIBDIRS:
+				if d + '/' + name in group:
+					keep.add(d + '/' + name)
+					break
+			if keep:
+				break
+	target = os.path.basename(sorted(keep)[0])
+
+	actions = {}
+	for path in group:
+		if path in keep:
+			continue
+		d, name = os.path.split(path)
+		# The copy -l would find first becomes a script, shadowed ones go.
+		first = USR + '/' + name if os.path.exists(full(USR + '/' + name)) else LIB + '/' + name
+		if is_dev_name(name) and path == first:
+			actions[path] = target
+		else:
+			actions[path] = None
+	return actions, os.path.getsize(full(group[0])) * len(actions)
+
+
+def main():
+	parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+	parser.add_argument('--dry-run', action='store_true', help='print what would change')
+	args = parser.parse_args()
+
+	groups, required = scan()
+	saved = 0
+	for group in sorted(groups):
+		actions, size = plan(group, required)
+		saved += size
+		for path, target in sorted(actions.items()):
+			if args.dry_run:
+				print('%s -> %s' % (path, target and SCRIPT.strip() % target or 'deleted'))
+				continue
+			os.remove(full(path))
+			if target:
+				with open(full(path), 'w', newline='\n') as f:
+					f.write(SCRIPT % target)
+	print('%s %.1f MiB' % ('would save' if args.dry_run else 'saved', saved / 2**20), file=sys.stderr)
+
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Reads the ring a program writes with GC_telemetry_start.
+
+Prints one line per collection recorded in the file (see
+include/gc/gc_telemetry.h), and with --follow keeps polling it for new
+ones, so GC pauses can be lined up with latency graphs without touching
+the program:
+
+    tools/gctelemetry.py /dev/shm/myservice.gc
+    tools/gctelemetry.py /dev/shm/myservice.gc --follow --json
+"""
+
+import argparse
+import json
+import mmap
+import struct
+import sys
+import time
+
+MAGIC = 0x544d454c45544347
+HEADER = struct.Struct('<8Q')
+FIELDS = ['seq', 'gc_no', 'start_ns', 'duration_ns', 'pause_ns', 'mark_ns', 'reclaim_ns',
+	'heap_size', 'free_bytes', 'bytes_reclaimed', 'bytes_allocd', 'markers', 'mark_cpu_ns']
+RECORD = struct.Struct('<16Q')
+
+
+class Ring:
+	def __init__(self, path):
+		with open(path, 'rb') as f:
+			self.map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+		magic, self.version, self.record_size, self.capacity, self.pid, _, _, _ = \
+			HEADER.unpack_from(self.map, 0)
+		if magic != MAGIC:
+			raise ValueError('%s: not a GC telemetry ring' % path)
+		if self.record_size < RECORD.size:
+			raise ValueError('%s: records of %d bytes, expected %d' % (path, self.record_size, RECORD.size))
+
+	def head(self):
+		return struct.unpack_from('<Q', self.map, 5 * 8)[0]
+
+	def read(self, index):
+		"""Returns record index as a dict, or None if it was overwritten."""
+		off = HEADER.size + (index % self.capacity) * self.record_size
+		seq = struct.unpack_from('<Q', self.map, off)[0]
+		if seq != 2 * (index + 1):
+			return None
+		values = RECORD.unpack_from(self.map, off)
+		if struct.unpack_from('<Q', self.map, off)[0] != seq:
+			return None
+		rec = dict(zip(FIELDS, values))
+		busy = rec['mark_ns'] * rec['markers']
+		rec['marker_utilization'] = rec['mark_cpu_ns'] / busy if busy else 0.0
+		return rec
+
+
+def main():
+	parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+	parser.add_argument('path', help='file given to GC_telemetry_start')
+	parser.add_argument('--follow', action='store_true', help='keep polling for new collections')
+	parser.add_argument('--interval', type=float, default=0.1, help='polling interval in seconds')
+	parser.add_argument('--json', action='store_true', help='print JSON lines')
+	args = parser.parse_args()
+
+	ring = Ring(args.path)
+	head = ring.head()
+	index = max(0, head - ring.capacity)
+	if not args.json:
+		print('%8s %10s %10s %10s %10s %10s %12s %12s %7s' % ('gc_no', 'start_ms', 'total_us',
+			'pause_us', 'mark_us', 'sweep_us', 'heap_kib', 'freed_kib', 'mark%'))
+	while True:
+		for index in range(index, head):
+			rec = ring.read(index)
+			if rec is None:
+				print('lost record %d' % index, file=sys.stderr)
+				continue
+			if args.json:
+				print(json.dumps(rec))
+			else:
+				print('%8d %10.1f %10d %10d %10d %10d %12d %12d %6.0f%%' % (rec['gc_no'],
+					rec['start_ns'] / 1e6, rec['duration_ns'] // 1000, rec['pause_ns'] // 1000,
+					rec['mark_ns'] // 1000, rec['reclaim_ns'] // 1000, rec['heap_size'] // 1024,
+					rec['bytes_reclaimed'] // 1024, 100 * rec['marker_utilization']))
+		index = head
+		if not args.follow:
+			return 0
+		sys.stdout.flush()
+		while ring.head() == head:
+			time.sleep(args.interval)
+		head = ring.head()
+
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -0,0 +1,34 @@
+#!/bin/sh
+# Packs the root for distribution as a read-only image:
+#   tools/pack.sh vlinuxroot.sqfs    squashfs, zstd; mount -o loop,ro or squashfuse
+#   tools/pack.sh vlinuxroot.tar.zst
+#   tools/pack.sh vlinuxroot.tar.xz
+# A squashfs image is decompressed block by block as files are read, so a
+# mounted root costs only what a build touches and shares one page cache
+# across jobs. The tarballs are for hosts that can't mount it.
+set -e
+
+if [ $# -ne 1 ]; then
+	echo "usage: $0 OUTPUT.{sqfs,tar.zst,tar.xz}" >&2
+	exit 2
+fi
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+OUT=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+CONTENTS="LICENSE README.md crt1.o crti.o crtn.o ld.lld ld.lld.rsp include lib usr"
+
+cd "$ROOT"
+rm -f "$OUT"
+case $OUT in
+*.sqfs)
+	mksquashfs $CONTENTS "$OUT" -comp zstd -Xcompression-level 19 -b 1M \
+		-all-root -noappend -quiet ;;
+*.tar.zst)
+	tar -cf - --owner=0 --group=0 $CONTENTS | zstd -19 --long -T0 -q -o "$OUT" ;;
+*.tar.xz)
+	tar -cf - --owner=0 --group=0 $CONTENTS | xz -9 -T0 > "$OUT" ;;
+*)
+	echo "$0: unknown format: $OUT" >&2
+	exit 2 ;;
+esac
+ls -l "$OUT"
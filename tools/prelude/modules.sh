@@ -0,0 +1,50 @@
+#!/bin/sh
+# Checks include/module.modulemap with clang: builds every module in it,
+# then compiles prelude.h, and code using what it declares, through them.
+# A header the map gets wrong (a type left invisible, a header that can't
+# be built on its own) fails here rather than in a V build.  The prelude is
+# compiled with and without GC_THREADS, which must redirect pthread_create:
+#   tools/prelude/modules.sh
+#   CC='clang --target=x86_64-linux-gnu' CFLAGS='-D_GNU_SOURCE' tools/prelude/modules.sh
+set -e
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+CC=${CC:-clang}
+MAP=$ROOT/include/module.modulemap
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+check() {
+	$CC $CFLAGS --sysroot="$ROOT" -isystem "$ROOT/include" -fmodules \
+		-fmodule-map-file="$MAP" -fmodules-cache-path="$TMP/cache" -fsyntax-only "$@"
+}
+
+for module in $(sed -n 's/^module \([A-Za-z0-9_]*\) .*/\1/p' "$MAP"); do
+	printf '#pragma clang module import %s\n' "$module" > "$TMP/$module.c"
+	check "$TMP/$module.c"
+	echo "$module: ok"
+done
+
+cat > "$TMP/prelude.c" <<EOF
+#include "$ROOT/tools/prelude/prelude.h"
+
+int main(void)
+{
+	FILE *out = stdout;
+	uint64_t n = UINT64_MAX;
+	pthread_t self = pthread_self();
+	struct stat st;
+	char *p = GC_MALLOC(16);
+
+	fprintf(out, "%" PRIu64 " %d %d\n", n, (int)(self != 0), stat(p, &st));
+	return errno;
+}
+
+#if defined(GC_THREADS) && !defined(pthread_create)
+#error "gc.h did not redirect pthread_create with GC_THREADS"
+#endif
+EOF
+check "$TMP/prelude.c"
+echo "prelude.h: ok"
+check -DGC_THREADS=1 "$TMP/prelude.c"
+echo "prelude.h with GC_THREADS: ok"
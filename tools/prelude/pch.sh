@@ -0,0 +1,33 @@
+#!/bin/sh
+# Precompiles prelude.h against the root into OUTDIR, so repeated cross-builds
+# of V programs don't reparse the glibc, kernel and libgc headers:
+#   tools/prelude/pch.sh OUTDIR
+#   CC='clang --target=x86_64-linux-gnu' CFLAGS='-O2 -DGC_THREADS=1' tools/prelude/pch.sh OUTDIR
+# then compile with the same compiler and flags plus -include OUTDIR/prelude.h.
+# CFLAGS must carry every -D the program is compiled with: gc.h declares
+# different things with GC_THREADS (pthread_create and friends redirected
+# to GC_pthread_*, which V's -gc boehm builds need), GC_DEBUG and the
+# like.  The compiler and flags are recorded in OUTDIR/prelude.flags.
+# gcc finds OUTDIR/prelude.h.gch and clang OUTDIR/prelude.h.pch on its own; a
+# compiler or flag mismatch makes gcc ignore the PCH (warn with -Winvalid-pch)
+# and clang reject it, so rebuild it whenever either changes.
+set -e
+
+if [ $# -ne 1 ]; then
+	echo "usage: $0 OUTDIR" >&2
+	exit 2
+fi
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+CC=${CC:-cc}
+OUT=$1
+
+mkdir -p "$OUT"
+cp "$ROOT/tools/prelude/prelude.h" "$OUT/prelude.h"
+case $($CC --version 2>/dev/null) in
+*clang*) PCH=$OUT/prelude.h.pch ;;
+*) PCH=$OUT/prelude.h.gch ;;
+esac
+$CC $CFLAGS --sysroot="$ROOT" -isystem "$ROOT/include" -x c-header "$OUT/prelude.h" -o "$PCH"
+printf '%s\n' "$CC $CFLAGS" > "$OUT/prelude.flags"
+echo "$PCH"
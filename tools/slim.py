@@ -0,0 +1,303 @@
+#!/usr/bin/env python3
+"""Dependency manifest and minimal sub-roots.
+
+'manifest' writes every header, library, object and linker script in the
+root as JSON, each with its dependency edges: #include for headers,
+DT_NEEDED for shared libraries and GROUP/INPUT for linker scripts.
+
+'slim' copies the closure a program needs into a new directory that can
+be used as --sysroot in place of the whole root. The seeds are the crt
+files, libc, libm, libpthread and libdl, the headers of V's C prelude
+(tools/prelude/prelude.h), and whatever the given V files ask for with
+#include <...> and #flag -l..., plus any -H/-l given directly:
+
+    tools/slim.py manifest -o manifest.json
+    tools/slim.py slim /tmp/vroot --v main.v
+    tools/slim.py slim /tmp/vroot -l ssl -l crypto -H openssl/ssl.h --static
+    tools/slim.py slim /tmp/vroot --v main.v --dry-run
+
+Include edges are collected without evaluating #if, so the closure can be
+a little larger than what one configuration uses, never smaller.
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import struct
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+INCLUDE = 'include'
+LIBDIRS = ['usr/lib/x86_64-linux-gnu', 'lib/x86_64-linux-gnu']
+GCCDIR = 'usr/lib/gcc/x86_64-linux-gnu/12'
+CRT = ['crt1.o', 'crti.o', 'crtn.o', 'usr/lib/crt1.o'] + \
+	['usr/lib/x86_64-linux-gnu/' + f for f in ('crt1.o', 'crti.o', 'crtn.o', 'Scrt1.o', 'rcrt1.o')]
+BASE_LIBS = ['c', 'm', 'pthread', 'dl']
+PRELUDE = 'tools/prelude/prelude.h'
+# Headers that come with the compiler rather than the root.
+COMPILER_HEADERS = {'float.h', 'iso646.h', 'stdalign.h', 'stdarg.h', 'stdatomic.h',
+	'stdbool.h', 'stddef.h', 'stdnoreturn.h', 'varargs.h', 'cpuid.h'}
+
+INCLUDE_RE = re.compile(r'^\s*#\s*include\s*([<"])([^>"]+)[>"]', re.M)
+FLAG_RE = re.compile(r'^\s*#flag\s+(?:\w+\s+)?(.*)$', re.M)
+SCRIPT_RE = re.compile(r'\b(?:GROUP|INPUT)\s*\(([^)]*(?:\([^)]*\)[^)]*)*)\)')
+DT_NEEDED, DT_SONAME = 1, 14
+SHT_DYNAMIC = 6
+
+
+def rel(path):
+	return os.path.relpath(path, ROOT).replace(os.sep, '/')
+
+
+def full(relpath):
+	return os.path.join(ROOT, *relpath.split('/'))
+
+
+def read_elf_dynamic(path):
+	"""Returns (soname, [needed]) for an ELF shared object, or None."""
+	with open(path, 'rb') as f:
+		data = f.read()
+	if data[:4] != b'\x7fELF' or data[5] != 1:
+		return None
+	is64 = data[4] == 2
+	if is64:
+		shoff, = struct.unpack_from('<Q', data, 0x28)
+		shentsize, shnum = struct.unpack_from('<HH', data, 0x3a)
+		shdr, dyn = '<IIQQQQIIQQ', '<qQ'
+	else:
+		shoff, = struct.unpack_from('<I', data, 0x20)
+		shentsize, shnum = struct.unpack_from('<HH', data, 0x2e)
+		shdr, dyn = '<IIIIIIIIII', '<iI'
+	sections = [struct.unpack_from(shdr, data, shoff + i * shentsize) for i in range(shnum)]
+	soname, needed = None, []
+	for sh in sections:
+		if sh[1] != SHT_DYNAMIC:
+			continue
+		offset, size, link = sh[4], sh[5], sh[6]
+		strtab = sections[link][4]
+		string = lambda o: data[strtab + o:data.index(b'\0', strtab + o)].decode()
+		for off in range(offset, offset + size, struct.calcsize(dyn)):
+			tag, val = struct.unpack_from(dyn, data, off)
+			if tag == DT_NEEDED:
+				needed.append(string(val))
+			elif tag == DT_SONAME:
+				soname = string(val)
+	return soname, needed
+
+
+def read_ld_script(path):
+	"""Returns the inputs named by a GNU ld script, or None if it isn't one."""
+	with open(path, 'rb') as f:
+		head = f.read(4096)
+	if b'\0' in head:
+		return None
+	text = re.sub(r'/\*.*?\*/', '', head.decode(errors='replace'), flags=re.S)
+	inputs = []
+	for group in SCRIPT_RE.findall(text):
+		inputs += [t for t in re.split(r'[\s(),]+', group) if t and t != 'AS_NEEDED']
+	return inputs if inputs else None
+
+
+def find_library(name, static=False):
+	"""Resolves -lNAME the way the linker does with the root's -L order."""
+	exts = ['.a', '.so'] if static else ['.so', '.a']
+	for d in LIBDIRS:
+		for ext in exts:
+			candidate = d + '/lib' + name + ext
+			if os.path.exists(full(candidate)):
+				return candidate
+	return None
+
+
+def find_soname(soname):
+	for d in LIBDIRS:
+		if os.path.exists(full(d + '/' + soname)):
+			return d + '/' + soname
+	return None
+
+
+def resolve_include(name, quoted, from_dir):
+	candidates = [from_dir + '/' + name] if quoted and from_dir else []
+	candidates.append(INCLUDE + '/' + name)
+	for c in candidates:
+		c = os.path.normpath(c).replace(os.sep, '/')
+		if os.path.isfile(full(c)):
+			return c
+	return None
+
+
+def header_deps(relpath):
+	with open(full(relpath), encoding='latin-1') as f:
+		text = f.read()
+	deps, missing = [], []
+	for kind, name in INCLUDE_RE.findall(text):
+		dep = resolve_include(name, kind == '"', os.path.dirname(relpath))
+		if dep is None:
+			missing.append(name)
+		elif dep != relpath and dep not in deps:
+			deps.append(dep)
+	return deps, missing
+
+
+def library_deps(relpath):
+	"""Returns (kind, deps, missing, extra) for a file in a library directory."""
+	path = full(relpath)
+	inputs = read_ld_script(path)
+	if inputs is not None:
+		deps, missing = [], []
+		for i in inputs:
+			if i.startswith('-l'):
+				dep = find_library(i[2:])
+			elif '/' in i:
+				dep = i.lstrip('/') if os.path.exists(full(i.lstrip('/'))) else None
+			else:
+				# A bare name, as in INPUT(libX11.so.6), is searched for in
+				# the library directories.
+				dep = find_soname(i)
+			(deps if dep else missing).append(dep or i)
+		return 'ldscript', deps, missing, {}
+	dynamic = read_elf_dynamic(path)
+	if dynamic is not None:
+		soname, needed = dynamic
+		deps, missing = [], []
+		if soname and os.path.basename(relpath) != soname:
+			dep = find_soname(soname)
+			(deps if dep else missing).append(dep or soname)
+		for n in needed:
+			dep = find_soname(n)
+			(deps if dep else missing).append(dep or n)
+		return 'elf', deps, missing, {'soname': soname, 'needed': needed}
+	kind = 'archive' if relpath.endswith('.a') else 'object' if relpath.endswith('.o') else 'file'
+	return kind, [], [], {}
+
+
+def build_manifest():
+	files = {}
+	for top in (INCLUDE, 'lib', 'usr'):
+		for dirpath, _, names in os.walk(full(top)):
+			for name in sorted(names):
+				relpath = rel(os.path.join(dirpath, name))
+				entry = {'size': os.path.getsize(full(relpath))}
+				if relpath.startswith(INCLUDE + '/'):
+					kind = 'header'
+					deps, missing = header_deps(relpath) if name.endswith('.h') else ([], [])
+					extra = {}
+				else:
+					kind, deps, missing, extra = library_deps(relpath)
+				entry['kind'] = kind
+				entry.update(extra)
+				entry['deps'] = deps
+				if missing:
+					entry['missing'] = missing
+				files[relpath] = entry
+	return files
+
+
+def parse_v(path):
+	"""Returns (headers, libraries) requested by a V source file."""
+	with open(path, encoding='utf-8') as f:
+		text = f.read()
+	headers = [name for kind, name in INCLUDE_RE.findall(text) if kind == '<']
+	libs = []
+	for flags in FLAG_RE.findall(text):
+		for flag in flags.split():
+			if flag.startswith('-l'):
+				libs.append(flag[2:])
+	return headers, libs
+
+
+def closure(files, seeds):
+	seen, todo = set(), list(seeds)
+	while todo:
+		f = todo.pop()
+		if f in seen or f not in files:
+			continue
+		seen.add(f)
+		todo += files[f]['deps']
+	return seen
+
+
+def slim(args):
+	files = build_manifest()
+	headers, libs = list(args.header), list(BASE_LIBS) + list(args.lib)
+	if not args.no_prelude:
+		headers += parse_v(full(PRELUDE))[0]
+	for v in args.v:
+		h, l = parse_v(v)
+		headers += h
+		libs += l
+
+	seeds = CRT + ['ld.lld.rsp']
+	missing = []
+	for h in headers:
+		if h in COMPILER_HEADERS or h.endswith('intrin.h'):
+			continue
+		dep = resolve_include(h, False, None)
+		(seeds.append(dep) if dep else missing.append('<%s>' % h))
+	for l in libs:
+		dep = find_library(l, args.static)
+		(seeds.append(dep) if dep else missing.append('-l' + l))
+	if args.static:
+		seeds += [f for f in files if f.startswith(GCCDIR + '/')]
+	else:
+		dep = find_soname('ld-linux-x86-64.so.2')
+		(seeds.append(dep) if dep else missing.append('ld-linux-x86-64.so.2'))
+	if args.ld:
+		seeds.append('ld.lld')
+
+	keep = closure(files, seeds) | {s for s in seeds if os.path.exists(full(s))}
+	size = sum(os.path.getsize(full(f)) for f in keep)
+	total = sum(e['size'] for e in files.values())
+	for m in missing:
+		print('not in the root: %s' % m, file=sys.stderr)
+	for f in sorted(keep):
+		if f in files and files[f]['kind'] != 'header' and files[f].get('missing'):
+			print('warning: %s needs %s, which the root lacks' % (f, ', '.join(files[f]['missing'])),
+				file=sys.stderr)
+	if args.dry_run:
+		for f in sorted(keep):
+			print(f)
+	else:
+		for f in sorted(keep):
+			dst = os.path.join(args.outdir, *f.split('/'))
+			os.makedirs(os.path.dirname(dst), exist_ok=True)
+			shutil.copy2(full(f), dst)
+	print('%d files, %.1f MiB of %.1f MiB' % (len(keep), size / 2**20, total / 2**20), file=sys.stderr)
+	return 1 if missing else 0
+
+
+def main():
+	parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+	sub = parser.add_subparsers(dest='command', required=True)
+	m = sub.add_parser('manifest', help='write the dependency manifest as JSON')
+	m.add_argument('-o', '--output', help='output file (default: stdout)')
+	s = sub.add_parser('slim', help='copy the closure of a program into OUTDIR')
+	s.add_argument('outdir')
+	s.add_argument('--v', action='append', default=[], metavar='FILE',
+		help='V file whose #include <...> and #flag -l... to honour (repeatable)')
+	s.add_argument('-H', '--header', action='append', default=[], metavar='HEADER',
+		help='header as written in #include <...> (repeatable)')
+	s.add_argument('-l', '--lib', action='append', default=[], metavar='NAME',
+		help='library as passed to -l (repeatable)')
+	s.add_argument('--static', action='store_true',
+		help='prefer .a archives and add the GCC crt files and libgcc')
+	s.add_argument('--no-prelude', action='store_true', help="don't add V's prelude headers")
+	s.add_argument('--ld', action='store_true', help='also copy the bundled ld.lld')
+	s.add_argument('--dry-run', action='store_true', help='list the files instead of copying')
+	args = parser.parse_args()
+
+	if args.command == 'manifest':
+		manifest = json.dumps(build_manifest(), indent=1, sort_keys=True)
+		if args.output:
+			with open(args.output, 'w') as f:
+				f.write(manifest + '\n')
+		else:
+			print(manifest)
+		return 0
+	return slim(args)
+
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -0,0 +1,26 @@
+#!/bin/sh
+# Strips DWARF from the static archives in the root and keeps the original,
+# unstripped archive under usr/lib/debug/ at the same relative path:
+#   tools/splitdebug.sh
+# A static link reads every member it pulls in, debug sections included, and
+# the linker only copies them into the output to be stripped later, so the
+# archives used by default carry none. For a build that needs source-level
+# debugging of those libraries, put the debug tree first on the search path:
+#   -L usr/lib/debug/usr/lib/x86_64-linux-gnu -L usr/lib/debug/lib/x86_64-linux-gnu
+# It is idempotent; run it again after adding archives.
+set -e
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+STRIP=${STRIP:-strip}
+READELF=${READELF:-readelf}
+
+cd "$ROOT"
+for lib in lib/x86_64-linux-gnu/*.a usr/lib/x86_64-linux-gnu/*.a; do
+	# Linker scripts and archives without DWARF are left alone.
+	"$READELF" -S --wide "$lib" 2>/dev/null | grep -q '\.debug_' || continue
+	debug=usr/lib/debug/$lib
+	mkdir -p "$(dirname "$debug")"
+	cp -p "$lib" "$debug"
+	"$STRIP" --strip-debug -D "$lib"
+	echo "$lib: $(wc -c < "$debug") -> $(wc -c < "$lib") bytes"
+done